@@ -0,0 +1,74 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <phi/core/file.hpp>
+
+namespace Phi
+{
+    MappedFile::MappedFile(const std::string& path)
+    {
+        // Grab path
+        pathToFile = path;
+
+        // Convert to global (remove tokens)
+        globalPath = File::GlobalizePath(pathToFile);
+
+#ifdef _WIN32
+        // Open the file, letting others write, rename, or delete it while it is mapped
+        const DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+        HANDLE file = CreateFileA(globalPath.c_str(), GENERIC_READ, share, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        fileHandle = file;
+
+        // Map the whole file
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        mappingHandle = mapping;
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) return;
+        data = (const uint8_t*)view;
+        size = (size_t)fileSize.QuadPart;
+#else
+        // Open the file
+        const int fd = open(globalPath.c_str(), O_RDONLY);
+        if (fd == -1) return;
+
+        // Map the whole file (the mapping stays valid after the descriptor is closed)
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                data = (const uint8_t*)view;
+                size = info.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle) CloseHandle(fileHandle);
+#else
+        if (data) munmap((void*)data, size);
+#endif
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Phi
+{
+    // Read-only memory mapping of an entire file
+    // Contents are paged in by the OS on access, so large files can be read without copying
+    // Accepts the same special path tokens as Phi::File (data://, user://, phi://)
+    class MappedFile
+    {
+        // Interface
+        public:
+
+            // Maps the file at the given path, check IsOpen() for success
+            MappedFile(const std::string& path);
+            ~MappedFile();
+
+            // Delete copy constructor/assignment
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            // Delete move constructor/assignment
+            MappedFile(MappedFile&& other) = delete;
+            MappedFile& operator=(MappedFile&& other) = delete;
+
+            // Returns true if the file was mapped successfully
+            // NOTE: Empty files can not be mapped
+            bool IsOpen() const { return data != nullptr; }
+
+            // Data access
+            const uint8_t* GetData() const { return data; }
+            size_t GetSize() const { return size; }
+
+            // Path access
+            const std::string& GetPath() const { return pathToFile; }
+            const std::string& GetGlobalPath() const { return globalPath; }
+
+        // Data / implementation
+        private:
+
+            // Path as supplied in the constructor
+            std::string pathToFile;
+
+            // Globalized path
+            std::string globalPath;
+
+            // Mapped contents
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+
+#ifdef _WIN32
+            // Native handles
+            void* fileHandle = nullptr;
+            void* mappingHandle = nullptr;
+#endif
+    };
+}
@@ -1,6 +1,7 @@
 #include "aggregate_volume.hpp"
 
 #include <algorithm>
+#include <limits>
 
 namespace Phi
 {
@@ -27,6 +28,42 @@ namespace Phi
         return false;
     }
 
+    AggregateVolume::Containment AggregateVolume::Classify(const AABB& aabb) const
+    {
+        Containment result = Containment::Outside;
+        for (const Sphere& sphere : spheres)
+        {
+            if (sphere.Contains(aabb)) return Containment::Inside;
+            if (sphere.Intersects(aabb)) result = Containment::Partial;
+        }
+
+        for (const AABB& shape : aabbs)
+        {
+            if (shape.Contains(aabb)) return Containment::Inside;
+            if (shape.Intersects(aabb)) result = Containment::Partial;
+        }
+
+        return result;
+    }
+
+    AABB AggregateVolume::GetBounds() const
+    {
+        AABB bounds(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()));
+        for (const Sphere& sphere : spheres)
+        {
+            bounds.min = glm::min(bounds.min, sphere.position - sphere.radius);
+            bounds.max = glm::max(bounds.max, sphere.position + sphere.radius);
+        }
+
+        for (const AABB& aabb : aabbs)
+        {
+            bounds.min = glm::min(bounds.min, aabb.min);
+            bounds.max = glm::max(bounds.max, aabb.max);
+        }
+
+        return bounds;
+    }
+
     void AggregateVolume::AddSphere(const Sphere& sphere)
     {
         spheres.push_back(sphere);
@@ -22,8 +22,24 @@ namespace Phi
             AggregateVolume(AggregateVolume&& other) = default;
             AggregateVolume& operator=(AggregateVolume&& other) = default;
 
+            // How much of a region lies within the volume
+            enum class Containment
+            {
+                Outside,
+                Partial,
+                Inside
+            };
+
             // Intersection tests
             bool Intersects(const glm::vec3& point) const;
+
+            // Classifies a box against the volume, for rejecting or accepting whole regions at once
+            // NOTE: Conservative, a box covered only by several shapes together is Partial
+            Containment Classify(const AABB& aabb) const;
+
+            // Returns the box bounding every shape in the volume
+            // An empty volume returns an inverted box that intersects nothing
+            AABB GetBounds() const;
             
             // TODO: shape intersections as well
 
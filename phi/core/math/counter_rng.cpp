@@ -0,0 +1,108 @@
+#include "counter_rng.hpp"
+
+#include <algorithm>
+
+namespace Phi
+{
+    // Philox4x32 round multipliers and key increments (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+    static const uint32_t PHILOX_M0 = 0xD2511F53;
+    static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+    static const uint32_t PHILOX_W0 = 0x9E3779B9;
+    static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+    CounterRNG::CounterRNG(uint32_t seed)
+        : seed(seed)
+    {
+    }
+
+    CounterRNG::~CounterRNG()
+    {
+    }
+
+    glm::uvec4 CounterRNG::Generate(uint32_t a, uint32_t b, uint32_t c, uint32_t d) const
+    {
+        uint32_t c0 = a, c1 = b, c2 = c, c3 = d;
+        uint32_t k0 = seed, k1 = 0;
+        for (int round = 0; round < 10; ++round)
+        {
+            const uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+            const uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+            c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            c1 = (uint32_t)p1;
+            c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c3 = (uint32_t)p0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        return glm::uvec4(c0, c1, c2, c3);
+    }
+
+    void CounterRNG::FillFloats(std::span<float> out, float min, float max, uint32_t first, uint32_t b, uint32_t c) const
+    {
+        if (max < min) max = min;
+        const float range = max - min;
+        for (size_t i = 0; i < out.size(); i += 4)
+        {
+            const glm::uvec4 values = Generate(first + (uint32_t)(i / 4), b, c);
+            const size_t count = std::min<size_t>(4, out.size() - i);
+            for (size_t j = 0; j < count; ++j)
+            {
+                out[i + j] = min + ToFloat(values[j]) * range;
+            }
+        }
+    }
+
+    void CounterRNG::FillInts(std::span<int> out, int min, int max, uint32_t first, uint32_t b, uint32_t c) const
+    {
+        if (max < min) max = min;
+        for (size_t i = 0; i < out.size(); i += 4)
+        {
+            const glm::uvec4 values = Generate(first + (uint32_t)(i / 4), b, c);
+            const size_t count = std::min<size_t>(4, out.size() - i);
+            for (size_t j = 0; j < count; ++j)
+            {
+                out[i + j] = ToInt(values[j], min, max);
+            }
+        }
+    }
+
+    uint32_t CounterRNG::Stream::NextUInt()
+    {
+        if (next == 4)
+        {
+            values = rng.Generate(a, b, block++);
+            next = 0;
+        }
+        return values[next++];
+    }
+
+    float CounterRNG::Stream::NextFloat(float min, float max)
+    {
+        if (max < min) return min;
+        return min + ToFloat(NextUInt()) * (max - min);
+    }
+
+    int CounterRNG::Stream::NextInt(int min, int max)
+    {
+        if (max < min) return min;
+        return ToInt(NextUInt(), min, max);
+    }
+
+    glm::vec3 CounterRNG::Stream::RandomDirection()
+    {
+        // Generate direction
+        glm::vec3 dir(NextFloat(-1.0f, 1.0f), NextFloat(-1.0f, 1.0f), NextFloat(-1.0f, 1.0f));
+
+        // Protect against divide by zero
+        if (glm::length(dir) < 0.0001f)
+            return glm::vec3(0.0f, 1.0f, 0.0f);
+
+        // Normalize before returning
+        return glm::normalize(dir);
+    }
+
+    glm::vec3 CounterRNG::Stream::RandomPosition(const glm::vec3& min, const glm::vec3& max)
+    {
+        return glm::vec3(NextFloat(min.x, max.x), NextFloat(min.y, max.y), NextFloat(min.z, max.z));
+    }
+}
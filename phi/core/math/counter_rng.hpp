@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace Phi
+{
+    // Represents a seedable counter-based pseudo random number generator (Philox4x32-10)
+    // Every value is a pure function of the seed and a counter, so values can be generated
+    // in any order, on any thread, and are identical across platforms and standard libraries
+    // Counters are typically keyed by (index, tick, salt), e.g. a voxel or particle index and a simulation tick
+    class CounterRNG
+    {
+        // Interface
+        public:
+
+            CounterRNG(uint32_t seed = 0);
+            ~CounterRNG();
+
+            // Default copy constructor/assignment
+            CounterRNG(const CounterRNG&) = default;
+            CounterRNG& operator=(const CounterRNG&) = default;
+
+            // Default move constructor/assignment
+            CounterRNG(CounterRNG&& other) = default;
+            CounterRNG& operator=(CounterRNG&& other) = default;
+
+            // Seed management
+
+            // Sets the seed of this RNG instance
+            inline void SetSeed(uint32_t seed) { this->seed = seed; };
+
+            // Gets the seed of this RNG instance
+            inline uint32_t GetSeed() const { return seed; }
+
+            // Basic RNG
+
+            // Returns 4 uniformly distributed 32 bit values for the given counter
+            glm::uvec4 Generate(uint32_t a, uint32_t b = 0, uint32_t c = 0, uint32_t d = 0) const;
+
+            // Returns a uniformly distributed float within the range [0, 1) for the given counter
+            inline float NextFloat(uint32_t a, uint32_t b = 0, uint32_t c = 0) const { return ToFloat(Generate(a, b, c).x); }
+
+            // Batch generation
+            // Fills out with values derived from the counters (first + i, b, c), 4 values per counter
+
+            // Fills out with uniformly distributed floats within the range [min, max)
+            void FillFloats(std::span<float> out, float min, float max, uint32_t first = 0, uint32_t b = 0, uint32_t c = 0) const;
+
+            // Fills out with uniformly distributed ints within the range [min, max]
+            // NOTE: If max < min, min is always returned as a fail-safe
+            void FillInts(std::span<int> out, int min, int max, uint32_t first = 0, uint32_t b = 0, uint32_t c = 0) const;
+
+            // A sequence of random values derived from a single counter (a, b)
+            // Useful when one object needs several values, e.g. every property of a spawned particle
+            class Stream
+            {
+                // Interface
+                public:
+
+                    // Returns a uniformly distributed 32 bit value
+                    uint32_t NextUInt();
+
+                    // Generates a uniformly distributed float within the range [min, max)
+                    // NOTE: If max < min, min is always returned as a fail-safe
+                    float NextFloat(float min, float max);
+
+                    // Generates a uniformly distributed int within the range [min, max]
+                    // NOTE: If max < min, min is always returned as a fail-safe
+                    int NextInt(int min, int max);
+
+                    // Returns a normalized 3D direction vector
+                    glm::vec3 RandomDirection();
+
+                    // Returns a random position within the minimum and maximum bounds given
+                    glm::vec3 RandomPosition(const glm::vec3& min, const glm::vec3& max);
+
+                // Data / implementation
+                private:
+
+                    friend class CounterRNG;
+                    Stream(const CounterRNG& rng, uint32_t a, uint32_t b) : rng(rng), a(a), b(b) {}
+
+                    // Source and counter
+                    const CounterRNG& rng;
+                    uint32_t a, b;
+                    uint32_t block = 0;
+
+                    // Values generated for the current block, and the next one to return
+                    glm::uvec4 values{0};
+                    int next = 4;
+            };
+
+            // Returns the stream of values for the counter (a, b)
+            // NOTE: The stream references this instance, and must not outlive it
+            inline Stream GetStream(uint32_t a, uint32_t b = 0) const { return Stream(*this, a, b); }
+
+            // Converts a random 32 bit value to a float within the range [0, 1)
+            static inline float ToFloat(uint32_t x) { return (x >> 8) * (1.0f / 16'777'216.0f); }
+
+            // Converts a random 32 bit value to an int within the range [min, max], assuming min <= max
+            static inline int ToInt(uint32_t x, int min, int max)
+            {
+                const uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+                return (int)((int64_t)min + (int64_t)(((uint64_t)x * range) >> 32));
+            }
+
+        // Data / implementation
+        private:
+
+            // Seed
+            uint32_t seed;
+    };
+}
@@ -1,5 +1,8 @@
 #include "noise.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace Phi
 {
     Noise::Noise(int seed)
@@ -10,4 +13,82 @@ namespace Phi
     Noise::~Noise()
     {
     }
+
+    void Noise::SampleGrid(float* output, const glm::vec3& origin, int width, int height, int depth, int step) const
+    {
+        // Full resolution, one sample per point
+        if (step <= 1)
+        {
+            for (int z = 0; z < depth; ++z)
+            {
+                for (int y = 0; y < height; ++y)
+                {
+                    for (int x = 0; x < width; ++x)
+                    {
+                        *output++ = noise.GetNoise(origin.x + x, origin.y + y, origin.z + z);
+                    }
+                }
+            }
+            return;
+        }
+
+        // Coarse lattice dimensions, covering the far edges (which may lie just outside the grid)
+        const int coarseWidth = (width - 1 + step - 1) / step + 1;
+        const int coarseHeight = (height - 1 + step - 1) / step + 1;
+        const int coarseDepth = (depth - 1 + step - 1) / step + 1;
+        const float invStep = 1.0f / step;
+
+        // Sample the coarse lattice, then interpolate each coarse row along x to full width
+        // Every output row is then a weighted sum of 4 contiguous rows, which the compiler vectorizes
+        std::vector<float> coarse(coarseWidth);
+        std::vector<float> rows((size_t)width * coarseHeight * coarseDepth);
+        for (int k = 0; k < coarseDepth; ++k)
+        {
+            for (int j = 0; j < coarseHeight; ++j)
+            {
+                for (int i = 0; i < coarseWidth; ++i)
+                {
+                    coarse[i] = noise.GetNoise(origin.x + i * step, origin.y + j * step, origin.z + k * step);
+                }
+
+                float* row = &rows[(size_t)width * (j + coarseHeight * k)];
+                for (int x = 0; x < width; ++x)
+                {
+                    const int i = x / step;
+                    const float t = (x - i * step) * invStep;
+                    row[x] = i + 1 < coarseWidth ? coarse[i] + (coarse[i + 1] - coarse[i]) * t : coarse[i];
+                }
+            }
+        }
+
+        // Blend the 4 surrounding rows for each output row
+        for (int z = 0; z < depth; ++z)
+        {
+            const int k = z / step;
+            const int k1 = std::min(k + 1, coarseDepth - 1);
+            const float tz = (z - k * step) * invStep;
+
+            for (int y = 0; y < height; ++y)
+            {
+                const int j = y / step;
+                const int j1 = std::min(j + 1, coarseHeight - 1);
+                const float ty = (y - j * step) * invStep;
+
+                const float* r00 = &rows[(size_t)width * (j + coarseHeight * k)];
+                const float* r10 = &rows[(size_t)width * (j1 + coarseHeight * k)];
+                const float* r01 = &rows[(size_t)width * (j + coarseHeight * k1)];
+                const float* r11 = &rows[(size_t)width * (j1 + coarseHeight * k1)];
+                const float w00 = (1.0f - ty) * (1.0f - tz);
+                const float w10 = ty * (1.0f - tz);
+                const float w01 = (1.0f - ty) * tz;
+                const float w11 = ty * tz;
+
+                for (int x = 0; x < width; ++x)
+                {
+                    output[x] = r00[x] * w00 + r10[x] * w10 + r01[x] * w01 + r11[x] * w11;
+                }
+                output += width;
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -41,6 +41,14 @@ namespace Phi
             // GLM sampling helpers
             inline float Sample(const glm::vec2& pos) const { return Sample(pos.x, pos.y); }
             inline float Sample(const glm::vec3& pos) const { return Sample(pos.x, pos.y, pos.z); }
+
+            // Bulk sampling
+
+            // Fills output with noise sampled on a width x height x depth lattice of unit spacing starting at origin
+            // Output is laid out like Grid3D (x varies fastest, then y, then z) and must hold width * height * depth values
+            // If step > 1, noise is only sampled every step units along each axis and trilinearly interpolated in between
+            // NOTE: Much cheaper, but only accurate when step is small compared to the noise wavelength (1 / frequency)
+            void SampleGrid(float* output, const glm::vec3& origin, int width, int height, int depth, int step = 1) const;
         
         // Data / implementation
         private:
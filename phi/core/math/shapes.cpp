@@ -127,6 +127,24 @@ namespace Phi
         );
     }
 
+    bool AABB::Intersects(const AABB& aabb) const
+    {
+        return (
+            aabb.min.x <= max.x && aabb.max.x >= min.x &&
+            aabb.min.y <= max.y && aabb.max.y >= min.y &&
+            aabb.min.z <= max.z && aabb.max.z >= min.z
+        );
+    }
+
+    bool AABB::Contains(const AABB& aabb) const
+    {
+        return (
+            aabb.min.x >= min.x && aabb.max.x <= max.x &&
+            aabb.min.y >= min.y && aabb.max.y <= max.y &&
+            aabb.min.z >= min.z && aabb.max.z <= max.z
+        );
+    }
+
     bool AABB::Intersects(const Plane& plane) const
     {
         // Convert to center / extents form
@@ -292,6 +310,19 @@ namespace Phi
         return glm::distance(position, point) <= radius;
     }
 
+    bool Sphere::Intersects(const AABB& aabb) const
+    {
+        // Distance to the closest point of the box
+        return glm::distance(position, glm::clamp(position, aabb.min, aabb.max)) <= radius;
+    }
+
+    bool Sphere::Contains(const AABB& aabb) const
+    {
+        // Distance to the furthest corner of the box
+        const glm::vec3 furthest = glm::max(glm::abs(position - aabb.min), glm::abs(aabb.max - position));
+        return glm::length(furthest) <= radius;
+    }
+
     bool Sphere::Intersects(const Plane& plane) const
     {   
         return std::abs(plane.DistanceTo(position)) <= radius;
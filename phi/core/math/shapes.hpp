@@ -124,11 +124,15 @@ namespace Phi
         bool Intersects(const glm::vec3& point) const;
         bool Intersects(const glm::ivec3& point) const;
         bool Intersects(const Plane& plane) const;
+        bool Intersects(const AABB& aabb) const;
 
         // NOTE: May give false positives!
         // Mostly used for culling since false positives can be corrected later
         bool IntersectsFast(const Frustum& frustum) const;
 
+        // Containment tests
+        bool Contains(const AABB& aabb) const;
+
         // Accessors
         const glm::vec3& MinMax(bool minMax) const { return minMax ? max : min; };
 
@@ -193,6 +197,10 @@ namespace Phi
         bool Intersects(const glm::vec3& point) const;
         bool Intersects(const Plane& plane) const;
         bool Intersects(const Frustum& frustum) const;
+        bool Intersects(const AABB& aabb) const;
+
+        // Containment tests
+        bool Contains(const AABB& aabb) const;
 
         // Data
         glm::vec3 position{0.0f};
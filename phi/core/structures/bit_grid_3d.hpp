@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <phi/core/structures/free_list.hpp>
+
+namespace Phi
+{
+    // Represents a sparse regular 3D grid of single bits
+    // Each row along the X axis is packed into 64-bit words, so whole rows
+    // can be queried and combined with shifts, masks, and popcounts
+    // Words are stored in bricks of BRICK_ROWS x BRICK_ROWS rows (along Y and Z),
+    // which are only allocated while they contain set bits
+    class BitGrid3D
+    {
+        // Interface
+        public:
+
+            // Number of cells packed into a single word
+            static const int WORD_SHIFT = 6;
+            static const int WORD_BITS = 1 << WORD_SHIFT;
+
+            // Number of rows along Y and Z stored in a single brick (a power of two)
+            static const int BRICK_SHIFT = 3;
+            static const int BRICK_ROWS = 1 << BRICK_SHIFT;
+
+            // Creates a 3D bit grid with the following bounds (all bits initially unset):
+            // [0, width)
+            // [0, height)
+            // [0, depth)
+            BitGrid3D(int width, int height, int depth)
+            {
+                assert(width > 0 && height > 0 && depth > 0);
+                Resize(width, height, depth);
+            }
+
+            ~BitGrid3D()
+            {
+            }
+
+            // Delete copy constructor/assignment
+            BitGrid3D(const BitGrid3D&) = delete;
+            BitGrid3D& operator=(const BitGrid3D&) = delete;
+
+            // Delete move constructor/assignment
+            BitGrid3D(BitGrid3D&& other) = delete;
+            BitGrid3D& operator=(BitGrid3D&& other) = delete;
+
+            // Data access / modification
+
+            // Fast read access, no bounds checking
+            inline bool Get(int x, int y, int z) const
+            {
+                return (Word(x >> WORD_SHIFT, y, z) >> (x & (WORD_BITS - 1))) & 1;
+            }
+
+            // Sets or unsets a single bit, no bounds checking
+            inline void Set(int x, int y, int z, bool value = true)
+            {
+                int& brickIndex = table[BrickIndex(x >> WORD_SHIFT, y, z)];
+
+                // Allocate a new brick if needed
+                if (brickIndex == -1)
+                {
+                    if (!value) return;
+                    brickIndex = bricks.Insert(Brick());
+                }
+
+                // Update the bit and the brick's population
+                Brick& brick = bricks[brickIndex];
+                uint64_t& word = brick.words[RowIndex(y, z)];
+                const uint64_t bit = (uint64_t)1 << (x & (WORD_BITS - 1));
+                if ((bool)(word & bit) == value) return;
+                word ^= bit;
+                brick.count += value ? 1 : -1;
+
+                // Free the brick once it is empty
+                if (brick.count == 0)
+                {
+                    bricks.Erase(brickIndex);
+                    brickIndex = -1;
+                }
+            }
+
+            // Returns the given word of the row (y, z)
+            // Rows outside of the grid return outOfBounds (e.g. ~0 to treat the outside as solid)
+            // Bits past the width of the grid are always unset
+            inline uint64_t Row(int word, int y, int z, uint64_t outOfBounds = 0) const
+            {
+                if (y < 0 || z < 0 || y >= height || z >= depth) return outOfBounds;
+                return Word(word, y, z);
+            }
+
+            // Returns the six face neighbour bits of the given cell, in the order
+            // (-y, +y, -x, +x, -z, +z) from least to most significant bit
+            // Neighbours outside of the grid are reported as outOfBounds
+            inline uint32_t Neighbours(int x, int y, int z, bool outOfBounds = false) const
+            {
+                const int word = x >> WORD_SHIFT;
+                const int bit = x & (WORD_BITS - 1);
+
+                // Neighbours along X usually share the cell's word
+                const uint64_t row = Word(word, y, z);
+                const bool lower = x > 0 ? (bit > 0 ? (row >> (bit - 1)) & 1 : Word(word - 1, y, z) >> (WORD_BITS - 1)) : outOfBounds;
+                const bool upper = x < width - 1 ? (bit < WORD_BITS - 1 ? (row >> (bit + 1)) & 1 : Word(word + 1, y, z) & 1) : outOfBounds;
+
+                return (uint32_t)(y > 0 ? (Word(word, y - 1, z) >> bit) & 1 : outOfBounds) |
+                       (uint32_t)(y < height - 1 ? (Word(word, y + 1, z) >> bit) & 1 : outOfBounds) << 1 |
+                       (uint32_t)lower << 2 |
+                       (uint32_t)upper << 3 |
+                       (uint32_t)(z > 0 ? (Word(word, y, z - 1) >> bit) & 1 : outOfBounds) << 4 |
+                       (uint32_t)(z < depth - 1 ? (Word(word, y, z + 1) >> bit) & 1 : outOfBounds) << 5;
+            }
+
+            // Returns a mask of the valid bits in the given word of any row
+            inline uint64_t ValidBits(int word) const
+            {
+                const int remaining = width - word * WORD_BITS;
+                return remaining >= WORD_BITS ? ~(uint64_t)0 : ((uint64_t)1 << remaining) - 1;
+            }
+
+            // Clears the grid (unsets every bit and frees every brick)
+            void Clear()
+            {
+                std::fill(table.begin(), table.end(), -1);
+                bricks.Clear();
+            }
+
+            // Resizes and clears the grid
+            void Resize(int width, int height, int depth)
+            {
+                this->width = width;
+                this->height = height;
+                this->depth = depth;
+                wordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+                bricksY = (height + BRICK_ROWS - 1) / BRICK_ROWS;
+                bricksZ = (depth + BRICK_ROWS - 1) / BRICK_ROWS;
+                table.resize((size_t)wordsPerRow * bricksY * bricksZ);
+                Clear();
+            }
+
+            // Accessors
+            int GetWidth() const { return width; }
+            int GetHeight() const { return height; }
+            int GetDepth() const { return depth; }
+            int GetWordsPerRow() const { return wordsPerRow; }
+
+            // Returns the number of allocated bricks
+            size_t GetBrickCount() const { return bricks.Count(); }
+
+        // Data / implementation
+        private:
+
+            // A single word wide block of BRICK_ROWS x BRICK_ROWS rows
+            struct Brick
+            {
+                uint64_t words[BRICK_ROWS * BRICK_ROWS] = {};
+
+                // Number of set bits
+                int count = 0;
+            };
+
+            // Grid dimension boundaries
+            int width, height, depth;
+            int wordsPerRow;
+
+            // Brick table dimensions (bricks along X match wordsPerRow)
+            int bricksY, bricksZ;
+
+            // Data
+            std::vector<int> table;
+            FreeList<Brick> bricks;
+
+            // Calculate index into the brick table from a word position
+            inline size_t BrickIndex(int word, int y, int z) const
+            {
+                return word + wordsPerRow * ((size_t)(y >> BRICK_SHIFT) + (size_t)bricksY * (z >> BRICK_SHIFT));
+            }
+
+            // Calculate index into a brick's words from a row position
+            inline int RowIndex(int y, int z) const
+            {
+                return (y & (BRICK_ROWS - 1)) | (z & (BRICK_ROWS - 1)) << BRICK_SHIFT;
+            }
+
+            // Returns the given word of the row (y, z), no bounds checking
+            inline uint64_t Word(int word, int y, int z) const
+            {
+                const int brick = table[BrickIndex(word, y, z)];
+                return brick == -1 ? 0 : bricks[brick].words[RowIndex(y, z)];
+            }
+    };
+}
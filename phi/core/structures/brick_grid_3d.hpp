@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+#include <phi/core/structures/free_list.hpp>
+
+namespace Phi
+{
+    // Represents a sparse regular 3D grid of arbitrary data and size
+    // Cells are stored in fixed-size bricks that are only allocated where non-empty values exist,
+    // so memory grows with occupied volume rather than total volume
+    // Bricks are further grouped into regions, which count their allocated bricks, so queries
+    // like ray traversal can skip empty space a brick or a region at a time
+    // T must be trivially constructible and destructible
+    template <typename T>
+    class BrickGrid3D
+    {
+        // Interface
+        public:
+
+            // Width of a brick along each axis, in cells (a power of two)
+            static const int BRICK_SHIFT = 3;
+            static const int BRICK_SIZE = 1 << BRICK_SHIFT;
+
+            // Width of a region along each axis, in cells (a power of two multiple of BRICK_SIZE)
+            static const int REGION_SHIFT = BRICK_SHIFT + 2;
+            static const int REGION_SIZE = 1 << REGION_SHIFT;
+
+            // Creates a 3D brick grid with the following bounds:
+            // [0, width)
+            // [0, height)
+            // [0, depth)
+            // Empty value is initially a default constructed T() unless otherwise specified
+            BrickGrid3D(int width, int height, int depth, const T& emptyValue = T());
+            ~BrickGrid3D();
+
+            // Delete copy constructor/assignment
+            BrickGrid3D(const BrickGrid3D&) = delete;
+            BrickGrid3D& operator=(const BrickGrid3D&) = delete;
+
+            // Delete move constructor/assignment
+            BrickGrid3D(BrickGrid3D&& other) = delete;
+            BrickGrid3D& operator=(BrickGrid3D&& other) = delete;
+
+            // Data access / modification
+
+            // Fast read access, no bounds checking
+            // Cells in unallocated bricks hold the empty value
+            inline const T& Get(int x, int y, int z) const
+            {
+                const int brick = table[BrickIndex(x, y, z)];
+                return brick == -1 ? emptyValue : bricks[brick].cells[CellIndex(x, y, z)];
+            }
+
+            // Returns true if the brick containing the given cell is empty, no bounds checking
+            inline bool IsBrickEmpty(int x, int y, int z) const
+            {
+                return table[BrickIndex(x, y, z)] == -1;
+            }
+
+            // Returns true if every brick in the region containing the given cell is empty, no bounds checking
+            inline bool IsRegionEmpty(int x, int y, int z) const
+            {
+                return regionCounts[RegionIndex(x, y, z)] == 0;
+            }
+
+            // Write access, no bounds checking
+            // Allocates a brick on the first non-empty write to it, and frees it once every cell is empty again
+            void Set(int x, int y, int z, const T& value);
+
+            // Clears the grid (frees every brick)
+            void Clear();
+
+            // Resizes and clears the grid
+            void Resize(int width, int height, int depth);
+
+            // Accessors
+            int GetWidth() const { return width; }
+            int GetHeight() const { return height; }
+            int GetDepth() const { return depth; }
+            const T& GetEmptyValue() const { return emptyValue; }
+
+            // Returns the number of allocated bricks
+            size_t GetBrickCount() const { return bricks.Count(); }
+
+        // Data / implementation
+        private:
+
+            // A single block of BRICK_SIZE^3 cells
+            struct Brick
+            {
+                T cells[BRICK_SIZE * BRICK_SIZE * BRICK_SIZE];
+
+                // Number of non-empty cells
+                int count = 0;
+            };
+
+            // Grid dimension boundaries
+            int width, height, depth;
+
+            // Brick table dimensions
+            int bricksX, bricksY, bricksZ;
+
+            // Region table dimensions
+            int regionsX, regionsY, regionsZ;
+
+            // Data
+            T emptyValue;
+            std::vector<int> table;
+            FreeList<Brick> bricks;
+
+            // Number of allocated bricks in each region
+            std::vector<uint8_t> regionCounts;
+
+            // Calculate index into the brick table from 3D position
+            inline size_t BrickIndex(int x, int y, int z) const
+            {
+                return (x >> BRICK_SHIFT) + bricksX * ((size_t)(y >> BRICK_SHIFT) + (size_t)bricksY * (z >> BRICK_SHIFT));
+            }
+
+            // Calculate index into the region table from 3D position
+            inline size_t RegionIndex(int x, int y, int z) const
+            {
+                return (x >> REGION_SHIFT) + regionsX * ((size_t)(y >> REGION_SHIFT) + (size_t)regionsY * (z >> REGION_SHIFT));
+            }
+
+            // Calculate index into a brick's cells from 3D position
+            inline int CellIndex(int x, int y, int z) const
+            {
+                const int mask = BRICK_SIZE - 1;
+                return (x & mask) | (y & mask) << BRICK_SHIFT | (z & mask) << (2 * BRICK_SHIFT);
+            }
+    };
+
+    // Template implementation
+
+    template <typename T>
+    BrickGrid3D<T>::BrickGrid3D(int width, int height, int depth, const T& emptyValue)
+        : emptyValue(emptyValue)
+    {
+        assert(width > 0 && height > 0 && depth > 0);
+
+        // Initialize the grid
+        Resize(width, height, depth);
+    }
+
+    template <typename T>
+    BrickGrid3D<T>::~BrickGrid3D()
+    {
+    }
+
+    template <typename T>
+    void BrickGrid3D<T>::Set(int x, int y, int z, const T& value)
+    {
+        const bool empty = value == emptyValue;
+        int& brickIndex = table[BrickIndex(x, y, z)];
+
+        // Allocate a new brick if needed
+        if (brickIndex == -1)
+        {
+            if (empty) return;
+
+            Brick newBrick;
+            std::fill(std::begin(newBrick.cells), std::end(newBrick.cells), emptyValue);
+            brickIndex = bricks.Insert(newBrick);
+            regionCounts[RegionIndex(x, y, z)]++;
+        }
+
+        // Update the cell and the brick's occupancy
+        Brick& brick = bricks[brickIndex];
+        T& cell = brick.cells[CellIndex(x, y, z)];
+        brick.count += (int)!empty - (int)(cell != emptyValue);
+        cell = value;
+
+        // Free the brick once it is empty
+        if (brick.count == 0)
+        {
+            bricks.Erase(brickIndex);
+            brickIndex = -1;
+            regionCounts[RegionIndex(x, y, z)]--;
+        }
+    }
+
+    template <typename T>
+    void BrickGrid3D<T>::Clear()
+    {
+        std::fill(table.begin(), table.end(), -1);
+        std::fill(regionCounts.begin(), regionCounts.end(), 0);
+        bricks.Clear();
+    }
+
+    template <typename T>
+    void BrickGrid3D<T>::Resize(int width, int height, int depth)
+    {
+        // Set new dimensions
+        this->width = width;
+        this->height = height;
+        this->depth = depth;
+
+        // Calculate the new brick table size
+        bricksX = (width + BRICK_SIZE - 1) / BRICK_SIZE;
+        bricksY = (height + BRICK_SIZE - 1) / BRICK_SIZE;
+        bricksZ = (depth + BRICK_SIZE - 1) / BRICK_SIZE;
+        table.resize((size_t)bricksX * bricksY * bricksZ);
+
+        // Calculate the new region table size
+        regionsX = (width + REGION_SIZE - 1) / REGION_SIZE;
+        regionsY = (height + REGION_SIZE - 1) / REGION_SIZE;
+        regionsZ = (depth + REGION_SIZE - 1) / REGION_SIZE;
+        regionCounts.resize((size_t)regionsX * regionsY * regionsZ);
+        Clear();
+    }
+}
@@ -0,0 +1,121 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace Phi
+{
+    ThreadPool::ThreadPool(int threadCount)
+    {
+        // Leave one hardware thread for the caller by default
+        if (threadCount <= 0) threadCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+        // Start workers
+        workers.reserve(threadCount);
+        for (int i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back(&ThreadPool::WorkerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        // Signal all workers to finish
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobAvailable.notify_all();
+
+        // Wait for them to exit
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::Submit(const std::function<void()>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobs.push_back(job);
+        }
+        jobAvailable.notify_one();
+    }
+
+    void ThreadPool::ParallelFor(int count, const std::function<void(int)>& job, int maxThreads)
+    {
+        if (count <= 0) return;
+
+        // Determine how many workers should help the calling thread
+        int helpers = std::min((int)workers.size(), count - 1);
+        if (maxThreads > 0) helpers = std::min(helpers, maxThreads - 1);
+
+        // Run serially if no help is needed
+        if (helpers <= 0)
+        {
+            for (int i = 0; i < count; ++i) job(i);
+            return;
+        }
+
+        // Shared state for the batch
+        // Lives on the heap so helpers that start after the batch completes never touch a dead stack frame
+        struct Batch
+        {
+            std::function<void(int)> job;
+            int count = 0;
+            std::atomic<int> next{0};
+            std::atomic<int> completed{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto batch = std::make_shared<Batch>();
+        batch->job = job;
+        batch->count = count;
+
+        // Each participant pulls iterations until none remain
+        auto work = [batch]()
+        {
+            int done = 0;
+            for (int i = batch->next++; i < batch->count; i = batch->next++)
+            {
+                batch->job(i);
+                done++;
+            }
+
+            // The participant that completes the final iteration wakes the caller
+            if (done > 0 && batch->completed.fetch_add(done) + done == batch->count)
+            {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->finished.notify_all();
+            }
+        };
+
+        // Start helpers and participate
+        for (int i = 0; i < helpers; ++i) Submit(work);
+        work();
+
+        // Wait for any iterations still running on other threads
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&batch]() { return batch->completed == batch->count; });
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+
+            // Wait for a job or the stop signal
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            job();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Phi
+{
+    // A fixed-size pool of worker threads that execute queued jobs
+    // Used to spread simulation and generation work across cores
+    class ThreadPool
+    {
+        // Interface
+        public:
+
+            // Creates a pool with the given number of worker threads
+            // If threadCount is 0, one worker is created per hardware thread, minus one for the calling thread
+            ThreadPool(int threadCount = 0);
+            ~ThreadPool();
+
+            // Access to singleton instance
+            static ThreadPool& Instance()
+            {
+                // Constructed on first use
+                // Guaranteed to be destroyed
+                static ThreadPool instance;
+                return instance;
+            }
+
+            // Delete copy constructor/assignment
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // Delete move constructor/assignment
+            ThreadPool(ThreadPool&& other) = delete;
+            ThreadPool& operator=(ThreadPool&& other) = delete;
+
+            // Job management
+
+            // Queues a job to be run on the next available worker thread
+            void Submit(const std::function<void()>& job);
+
+            // Runs job(i) for every i in [0, count), spread across the workers and the calling thread
+            // Blocks until every iteration has completed
+            // maxThreads limits the number of threads used (including the caller), 0 means no limit
+            void ParallelFor(int count, const std::function<void(int)>& job, int maxThreads = 0);
+
+            // Accessors
+
+            // Returns the number of worker threads owned by the pool
+            int GetWorkerCount() const { return workers.size(); }
+
+        // Data / implementation
+        private:
+
+            // Worker threads
+            std::vector<std::thread> workers;
+
+            // Job queue
+            std::deque<std::function<void()>> jobs;
+            std::mutex jobMutex;
+            std::condition_variable jobAvailable;
+            bool stopping = false;
+
+            // Main loop for each worker thread
+            void WorkerLoop();
+    };
+}
@@ -0,0 +1,160 @@
+#version 460
+
+const int MAX_MATERIALS = 1024;
+
+// Global time
+uniform float time;
+
+// Camera uniform block
+layout(std140, binding = 0) uniform CameraBlock
+{
+    mat4 viewProj;
+    mat4 invViewProj;
+    mat4 view;
+    mat4 invView;
+    mat4 proj;
+    mat4 invProj;
+    vec4 cameraPos;
+    vec4 viewport; // (x, y, width / 2, height / 2)
+    vec4 nearFar; // x = near, y = far, z = null, w = null
+};
+
+struct MeshData
+{
+    mat4 transform;
+    mat4 invTransform;
+};
+
+struct PBRMaterial
+{
+    vec4 color;
+    vec4 emissive;
+    vec4 metallicRoughness;
+};
+
+layout(std430, binding = 1) buffer PBRMaterialBlock
+{
+    PBRMaterial pbrMaterials[MAX_MATERIALS];
+};
+
+layout(std430, binding = 3) restrict buffer QuadData
+{
+    uvec4 quadData[];
+};
+
+layout(std430, binding = 4) restrict buffer InstanceData
+{
+    MeshData meshData[];
+};
+
+// Fragment outputs
+out vec3 fragPos;
+out flat vec4 fragAlbedo;
+out flat vec4 fragEmissive;
+out flat vec2 fragMetallicRoughness;
+
+// A single iteration of Bob Jenkins' One-At-A-Time hashing algorithm.
+uint hash(uint x)
+{
+    x += ( x << 10u );
+    x ^= ( x >>  6u );
+    x += ( x <<  3u );
+    x ^= ( x >> 11u );
+    x += ( x << 15u );
+    return x;
+}
+
+// Construct a float with half-open range [0, 1) using low 23 bits
+// All zeroes yields 0.0, all ones yields the next smallest representable value below 1.0.
+float floatConstruct(uint m)
+{
+    // IEEE Binary32 Constants
+    const uint ieeeMantissa = 0x007FFFFFu;
+    const uint ieeeOne = 0x3F800000u;
+
+    // Only keep fractional part
+    m &= ieeeMantissa;
+    m |= ieeeOne;
+
+    // Adjust to range [0, 1]
+    float f = uintBitsToFloat(m);
+    return f - 1.0;
+}
+
+// Pseudo-random value in half-open range [0, 1)
+float random(float x)
+{
+    return floatConstruct(hash(floatBitsToUint(x)));
+}
+
+// Quad corners (in tangent space) for the two triangles of a quad
+const uvec2 corners[6] = uvec2[6](uvec2(0, 0), uvec2(1, 0), uvec2(1, 1), uvec2(0, 0), uvec2(1, 1), uvec2(0, 1));
+
+// Vertex shader entrypoint
+void main()
+{
+    // Calculate quad data index
+    // NOTE: gl_BaseInstance holds the index of the first quad for the current mesh
+    uint vertexID = gl_VertexID;
+    uint quadIndex = gl_BaseInstance + vertexID / 6u;
+
+    // Grab quad data
+    uvec4 quad = quadData[quadIndex];
+    ivec3 voxelPos = ivec3(bitfieldExtract(int(quad.x), 0, 16), bitfieldExtract(int(quad.x), 16, 16), bitfieldExtract(int(quad.y), 0, 16));
+    int voxelMaterial = bitfieldExtract(int(quad.y), 16, 16);
+    uvec2 size = uvec2(quad.z & 0xffffu, quad.z >> 16u);
+    uint face = quad.w & 0xffffu;
+
+    // Face axis and tangent axes
+    uint axis = face >> 1u;
+    uint u = (axis + 1u) % 3u;
+    uint v = (axis + 2u) % 3u;
+
+    // Negative faces swap tangent coordinates to reverse the winding
+    uvec2 corner = corners[vertexID % 6u];
+    if ((face & 1u) == 1u) corner = corner.yx;
+
+    // Generate quad position
+    vec3 localPos = vec3(voxelPos);
+    localPos[axis] += float(1u - (face & 1u));
+    localPos[u] += float(corner.x * size.x);
+    localPos[v] += float(corner.y * size.y);
+
+    // Apply mesh transformation to calculate world space position
+    vec4 worldPos = meshData[gl_DrawID].transform * vec4(localPos, 1.0);
+
+    // Special effects
+    vec4 albedo;
+    vec4 emissive;
+    vec2 metallicRoughness;
+    if (voxelMaterial == -1)
+    {
+        // Fire effect
+        // NOTE: Burning faces are never merged, so each quad belongs to a single voxel
+
+        // Uniform distribution between red and yellow, seeded per voxel so all faces match
+        float r = random(float(hash(uint(voxelPos.x) ^ hash(uint(voxelPos.y) ^ hash(uint(voxelPos.z)))) & 0xffffu) + time);
+
+        // Set material properties
+        emissive = vec4(mix(vec3(5, 0, 0), vec3(5, 1, 0), r), 1.0);
+        albedo = vec4(0.0, 0.0, 0.0, 1.0);
+        metallicRoughness = vec2(0.0);
+    }
+    else
+    {
+        // Load material
+        PBRMaterial material = pbrMaterials[voxelMaterial];
+        albedo = material.color;
+        emissive = material.emissive;
+        metallicRoughness = material.metallicRoughness.xy;
+    }
+
+    // Fragment outputs
+    fragPos = worldPos.xyz;
+    fragAlbedo = albedo;
+    fragEmissive = emissive;
+    fragMetallicRoughness = metallicRoughness;
+
+    // Set position
+    gl_Position = viewProj * worldPos;
+}
\ No newline at end of file
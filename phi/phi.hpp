@@ -8,12 +8,17 @@
 #include "core/file.hpp"
 #include "core/input.hpp"
 #include "core/logging.hpp"
+#include "core/mapped_file.hpp"
 #include "core/resource_manager.hpp"
+#include "core/thread_pool.hpp"
 #include "core/math/aggregate_volume.hpp"
 #include "core/math/constants.hpp"
+#include "core/math/counter_rng.hpp"
 #include "core/math/noise.hpp"
 #include "core/math/rng.hpp"
 #include "core/math/shapes.hpp"
+#include "core/structures/bit_grid_3d.hpp"
+#include "core/structures/brick_grid_3d.hpp"
 #include "core/structures/free_list.hpp"
 #include "core/structures/grid_3d.hpp"
 #include "core/structures/quadtree.hpp"
@@ -48,6 +53,9 @@
 #include "scene/components/renderable/environment.hpp"
 #include "scene/components/renderable/voxel_mesh.hpp"
 #include "scene/components/simulation/voxel_chunk.hpp"
+#include "scene/components/simulation/voxel_chunk_cache.hpp"
 #include "scene/components/simulation/voxel_map.hpp"
 #include "scene/components/simulation/voxel_material.hpp"
-#include "scene/components/simulation/voxel_object.hpp"
\ No newline at end of file
+#include "scene/components/simulation/voxel_object.hpp"
+#include "scene/components/simulation/voxel_object_format.hpp"
+#include "scene/components/simulation/voxel_scheduler.hpp"
\ No newline at end of file
@@ -119,6 +119,8 @@ namespace Phi
         oldest = std::move(other.oldest);
         totalElapsedTime = std::move(other.totalElapsedTime);
         spawnAccumulator = std::move(other.spawnAccumulator);
+        spawnCount = std::move(other.spawnCount);
+        spawnEvents = std::move(other.spawnEvents);
         rng = std::move(other.rng);
         offset = std::move(other.offset);
     }
@@ -141,6 +143,8 @@ namespace Phi
         oldest = std::move(other.oldest);
         totalElapsedTime = std::move(other.totalElapsedTime);
         spawnAccumulator = std::move(other.spawnAccumulator);
+        spawnCount = std::move(other.spawnCount);
+        spawnEvents = std::move(other.spawnEvents);
         rng = std::move(other.rng);
         offset = std::move(other.offset);
 
@@ -200,7 +204,7 @@ namespace Phi
                         if (numSpawns > 0)
                         {
                             // Calculate next spawnRate randomly
-                            particleProperties.spawnRateRandom = rng.NextFloat(particleProperties.spawnRateMin, particleProperties.spawnRateMax);
+                            RandomizeSpawnRate();
                         }
                         break;
                     
@@ -216,9 +220,8 @@ namespace Phi
                         spawnAccumulator -= (int)spawnAccumulator;
                         if (numSpawns > 0)
                         {
-                            // Calculate next spawnRate randomly
-                            particleProperties.spawnRateRandom = rng.NextFloat(particleProperties.spawnRateMin, particleProperties.spawnRateMax);
-                            particleProperties.burstCountRandom = rng.NextInt(particleProperties.burstCountMin, particleProperties.burstCountMax);
+                            // Calculate next spawnRate and burstCount randomly
+                            RandomizeSpawnRate();
                         }
                         break;
                     
@@ -265,6 +268,9 @@ namespace Phi
                 // Grab the next particle
                 Particle& spawned = particlePool[nextParticle];
 
+                // Each spawned particle draws its properties from its own stream
+                CounterRNG::Stream stream = rng.GetStream(spawnCount++, PARTICLE_STREAM);
+
                 // Initialize properties
                 spawned.ageNormalized = 0.0f;
 
@@ -276,11 +282,11 @@ namespace Phi
                         break;
                     
                     case PositionMode::RandomMinMax:
-                        spawned.position = rng.RandomPosition(particleProperties.positionMin, particleProperties.positionMax);
+                        spawned.position = stream.RandomPosition(particleProperties.positionMin, particleProperties.positionMax);
                         break;
                     
                     case PositionMode::RandomSphere:
-                        spawned.position = rng.RandomDirection() * rng.NextFloat(0.0f, 1.0f) * particleProperties.spawnRadius + particleProperties.position;
+                        spawned.position = stream.RandomDirection() * stream.NextFloat(0.0f, 1.0f) * particleProperties.spawnRadius + particleProperties.position;
                         break;
                 }
 
@@ -302,9 +308,9 @@ namespace Phi
                         break;
                     
                     case VelocityMode::RandomMinMax:
-                        spawned.velocity.x = rng.NextFloat(particleProperties.velocityMin.x, particleProperties.velocityMax.x);
-                        spawned.velocity.y = rng.NextFloat(particleProperties.velocityMin.y, particleProperties.velocityMax.y);
-                        spawned.velocity.z = rng.NextFloat(particleProperties.velocityMin.z, particleProperties.velocityMax.z);
+                        spawned.velocity.x = stream.NextFloat(particleProperties.velocityMin.x, particleProperties.velocityMax.x);
+                        spawned.velocity.y = stream.NextFloat(particleProperties.velocityMin.y, particleProperties.velocityMax.y);
+                        spawned.velocity.z = stream.NextFloat(particleProperties.velocityMin.z, particleProperties.velocityMax.z);
                         break;
                 }
 
@@ -318,13 +324,13 @@ namespace Phi
                         break;
                     
                     case ColorMode::RandomMinMax:
-                        spawned.color.r = rng.NextFloat(particleProperties.colorMin.r, particleProperties.colorMax.r);
-                        spawned.color.g = rng.NextFloat(particleProperties.colorMin.g, particleProperties.colorMax.g);
-                        spawned.color.b = rng.NextFloat(particleProperties.colorMin.b, particleProperties.colorMax.b);
+                        spawned.color.r = stream.NextFloat(particleProperties.colorMin.r, particleProperties.colorMax.r);
+                        spawned.color.g = stream.NextFloat(particleProperties.colorMin.g, particleProperties.colorMax.g);
+                        spawned.color.b = stream.NextFloat(particleProperties.colorMin.b, particleProperties.colorMax.b);
                         break;
                     
                     case ColorMode::RandomLerp:
-                        glm::vec3 interpolated = glm::mix(particleProperties.colorA, particleProperties.colorB, rng.NextFloat(0.0f, 1.0f));
+                        glm::vec3 interpolated = glm::mix(particleProperties.colorA, particleProperties.colorB, stream.NextFloat(0.0f, 1.0f));
                         spawned.color.r = interpolated.r;
                         spawned.color.g = interpolated.g;
                         spawned.color.b = interpolated.b;
@@ -339,12 +345,12 @@ namespace Phi
                         break;
                     
                     case SizeMode::RandomMinMax:
-                        spawned.size.x = rng.NextFloat(particleProperties.sizeMin.x, particleProperties.sizeMax.x);
-                        spawned.size.y = rng.NextFloat(particleProperties.sizeMin.y, particleProperties.sizeMax.y);
+                        spawned.size.x = stream.NextFloat(particleProperties.sizeMin.x, particleProperties.sizeMax.x);
+                        spawned.size.y = stream.NextFloat(particleProperties.sizeMin.y, particleProperties.sizeMax.y);
                         break;
                     
                     case SizeMode::RandomLerp:
-                        spawned.size = glm::mix(particleProperties.sizeMin, particleProperties.sizeMax, rng.NextFloat(0.0f, 1.0f));
+                        spawned.size = glm::mix(particleProperties.sizeMin, particleProperties.sizeMax, stream.NextFloat(0.0f, 1.0f));
                         break;
                 }
 
@@ -356,7 +362,7 @@ namespace Phi
                         break;
                     
                     case OpacityMode::RandomMinMax:
-                        spawned.color.a = rng.NextFloat(particleProperties.opacityMin, particleProperties.opacityMax);
+                        spawned.color.a = stream.NextFloat(particleProperties.opacityMin, particleProperties.opacityMax);
                         break;
                 }
                 
@@ -368,7 +374,7 @@ namespace Phi
                         break;
                     
                     case LifespanMode::RandomMinMax:
-                        spawned.lifespanNormalized = 1 / rng.NextFloat(particleProperties.lifespanMin, particleProperties.lifespanMax);
+                        spawned.lifespanNormalized = 1 / stream.NextFloat(particleProperties.lifespanMin, particleProperties.lifespanMax);
                         break;
                 }
             }
@@ -484,21 +490,25 @@ namespace Phi
         activeParticles = 0;
         totalElapsedTime = 0.0f;
         spawnAccumulator = 0.0f;
+        spawnCount = 0;
+        spawnEvents = 0;
         particleProperties.burstDone = false;
 
-        // Reset the seed
+        // Reset the seed (counters restart from 0, so a fixed seed repeats the same sequence)
         if (randomSeed)
         {
             rng.SetSeed(GLOBAL_RNG.NextInt(INT32_MIN, INT32_MAX));
         }
-        else
-        {
-            rng.Reseed();
-        }
 
         // Reset to default random values for this seed
-        particleProperties.spawnRateRandom = rng.NextFloat(particleProperties.spawnRateMin, particleProperties.spawnRateMax);
-        particleProperties.burstCountRandom = rng.NextInt(particleProperties.burstCountMin, particleProperties.burstCountMax);
+        RandomizeSpawnRate();
+    }
+
+    void CPUParticleEmitter::RandomizeSpawnRate()
+    {
+        CounterRNG::Stream stream = rng.GetStream(spawnEvents++, SPAWN_EVENT_STREAM);
+        particleProperties.spawnRateRandom = stream.NextFloat(particleProperties.spawnRateMin, particleProperties.spawnRateMax);
+        particleProperties.burstCountRandom = stream.NextInt(particleProperties.burstCountMin, particleProperties.burstCountMax);
     }
 
     void CPUParticleEmitter::Render(const glm::mat4& transform)
@@ -887,12 +897,11 @@ namespace Phi
             particleProperties.spawnRate = node["spawn_rate"] ? node["spawn_rate"].as<float>() : particleProperties.spawnRate;
             particleProperties.spawnRateMin = node["spawn_rate_min"] ? node["spawn_rate_min"].as<float>() : particleProperties.spawnRateMin;
             particleProperties.spawnRateMax = node["spawn_rate_max"] ? node["spawn_rate_max"].as<float>() : particleProperties.spawnRateMax;
-            particleProperties.spawnRateRandom = rng.NextFloat(particleProperties.spawnRateMin, particleProperties.spawnRateMax);
         
             particleProperties.burstCount = node["burst_count"] ? node["burst_count"].as<int>() : particleProperties.burstCount;
             particleProperties.burstCountMin = node["burst_count_min"] ? node["burst_count_min"].as<int>() : particleProperties.burstCountMin;
             particleProperties.burstCountMax = node["burst_count_max"] ? node["burst_count_max"].as<int>() : particleProperties.burstCountMax;
-            particleProperties.burstCountRandom = rng.NextInt(particleProperties.burstCountMin, particleProperties.burstCountMax);
+            RandomizeSpawnRate();
 
             duration = node["duration"] ? node["duration"].as<float>() : duration;
             maxActiveParticles = node["max_particles"] ? node["max_particles"].as<int>() : maxActiveParticles;
@@ -9,6 +9,7 @@
 #include <glm/glm.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include <phi/core/math/counter_rng.hpp>
 #include <phi/core/math/noise.hpp>
 #include <phi/core/math/rng.hpp>
 #include <phi/core/resource_manager.hpp>
@@ -318,7 +319,16 @@ namespace Phi
             float spawnAccumulator = 0.0f;
 
             // RNG Instance
-            RNG rng{4545};
+            // Every random value is keyed by a counter, so a fixed seed always replays the same effect
+            CounterRNG rng{4545};
+
+            // Number of particles spawned and of spawn rate draws since the last reset, used as RNG counters
+            uint32_t spawnCount = 0;
+            uint32_t spawnEvents = 0;
+
+            // RNG stream keys
+            static const uint32_t PARTICLE_STREAM = 0;
+            static const uint32_t SPAWN_EVENT_STREAM = 1;
 
             // Static resources
             
@@ -376,6 +386,9 @@ namespace Phi
             // Reference counting helpers
             static void IncreaseReferences();
 
+            // Draws the next random spawn rate and burst count
+            void RandomizeSpawnRate();
+
             // Friends
 
             // Necessary for effects to edit our properties
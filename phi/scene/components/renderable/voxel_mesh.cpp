@@ -1,5 +1,7 @@
 #include "voxel_mesh.hpp"
 
+#include <algorithm>
+
 #include <phi/scene/node.hpp>
 #include <phi/scene/components/transform.hpp>
 #include <phi/graphics/geometry.hpp>
@@ -29,10 +31,15 @@ namespace Phi
             // Cleanup static resources
             delete geometryPassShader;
             delete depthPassShader;
+            delete quadGeometryPassShader;
+            delete quadDepthPassShader;
             delete voxelDataBuffer;
             delete meshDataBuffer;
             delete indexBuffer;
             delete indirectBuffer;
+            delete quadDataBuffer;
+            delete quadMeshDataBuffer;
+            delete quadIndirectBuffer;
             glDeleteVertexArrays(1, &dummyVAO);
         }
     }
@@ -53,6 +60,16 @@ namespace Phi
             depthPassShader->LoadSource(GL_FRAGMENT_SHADER, "phi://graphics/shaders/empty.fs");
             depthPassShader->Link();
 
+            quadGeometryPassShader = new Shader();
+            quadGeometryPassShader->LoadSource(GL_VERTEX_SHADER, "phi://graphics/shaders/voxel_quad.vs");
+            quadGeometryPassShader->LoadSource(GL_FRAGMENT_SHADER, "phi://graphics/shaders/voxel_mesh.fs");
+            quadGeometryPassShader->Link();
+
+            quadDepthPassShader = new Shader();
+            quadDepthPassShader->LoadSource(GL_VERTEX_SHADER, "phi://graphics/shaders/voxel_quad.vs");
+            quadDepthPassShader->LoadSource(GL_FRAGMENT_SHADER, "phi://graphics/shaders/empty.fs");
+            quadDepthPassShader->Link();
+
             // Dummy vao
             glGenVertexArrays(1, &dummyVAO);
 
@@ -85,6 +102,11 @@ namespace Phi
             meshDataBuffer = new GPUBuffer(BufferType::DynamicDoubleBuffer, sizeof(glm::mat4) * 2 * MAX_DRAW_CALLS);
             indirectBuffer = new GPUBuffer(BufferType::DynamicDoubleBuffer, sizeof(DrawElementsCommand) * MAX_DRAW_CALLS);
 
+            // Quads are expanded from gl_VertexID, so they need no index buffer
+            quadDataBuffer = new GPUBuffer(BufferType::DynamicDoubleBuffer, sizeof(Quad) * MAX_QUADS);
+            quadMeshDataBuffer = new GPUBuffer(BufferType::DynamicDoubleBuffer, sizeof(glm::mat4) * 2 * MAX_DRAW_CALLS);
+            quadIndirectBuffer = new GPUBuffer(BufferType::DynamicDoubleBuffer, sizeof(DrawArraysCommand) * MAX_DRAW_CALLS);
+
             // Free up heap memory used for initial buffer construction
             delete indexData;
 
@@ -95,92 +117,171 @@ namespace Phi
         refCount++;
     }
 
-    void VoxelMesh::Render()
+    void VoxelMesh::MarkDirty(size_t first, size_t count)
     {
-        if (drawCount == MAX_DRAW_CALLS || queuedVoxels + vertices.size() > MAX_VOXELS) FlushRenderQueue();
+        if (allDirty) return;
 
-        // Sync if necessary
-        if (drawCount == 0) indirectBuffer->Sync();
+        // Merge with the previous range when touching or overlapping it
+        if (dirtyRanges.size() > 0)
+        {
+            DirtyRange& last = dirtyRanges.back();
+            if (first <= last.first + last.count && first + count >= last.first)
+            {
+                const size_t end = std::max(last.first + last.count, first + count);
+                last.first = std::min(last.first, first);
+                last.count = end - last.first;
+                return;
+            }
+        }
 
-        // Create indirect command
-        DrawElementsCommand cmd;
-        cmd.count = NUM_CUBE_INDS * vertices.size();
-        cmd.firstIndex = 0;
-        cmd.baseVertex = 0;
-        cmd.instanceCount = 1;
-        cmd.baseInstance = queuedVoxels; // So the vs knows where to start in the voxel buffer for this object
+        // Too many separate ranges, upload everything instead
+        if (dirtyRanges.size() == MAX_DIRTY_RANGES)
+        {
+            MarkAllDirty();
+            return;
+        }
 
-        // Write the command
-        indirectBuffer->Write(cmd);
+        dirtyRanges.push_back({first, count});
+    }
 
-        // Grab the node's transform
-        Transform* t = GetNode()->Get<Transform>();
-        glm::mat4 transform = t ? t->GetGlobalMatrix() : glm::mat4(1.0f);
+    void VoxelMesh::MarkAllDirty()
+    {
+        allDirty = true;
+        dirtyRanges.clear();
+    }
 
-        // Write the voxel and mesh data
-        voxelDataBuffer->Write(vertices.data(), vertices.size() * sizeof(Vertex));
-        meshDataBuffer->Write(transform);
-        meshDataBuffer->Write(glm::inverse(transform));
+    void VoxelMesh::ClearDirty()
+    {
+        allDirty = false;
+        dirtyRanges.clear();
+    }
 
-        // Update counters
-        drawCount++;
-        queuedVoxels += vertices.size();
+    void VoxelMesh::Render()
+    {
+        // Grab the node's transform
+        Transform* t = GetNode()->Get<Transform>();
+        Render(t ? t->GetGlobalMatrix() : glm::mat4(1.0f));
     }
 
     void VoxelMesh::Render(const glm::mat4& transform)
     {
-        if (drawCount == MAX_DRAW_CALLS || queuedVoxels + vertices.size() > MAX_VOXELS) FlushRenderQueue();
-
-        // Sync if necessary
-        if (drawCount == 0) indirectBuffer->Sync();
-
-        // Create indirect command
-        DrawElementsCommand cmd;
-        cmd.count = NUM_CUBE_INDS * vertices.size();
-        cmd.firstIndex = 0;
-        cmd.baseVertex = 0;
-        cmd.instanceCount = 1;
-        cmd.baseInstance = queuedVoxels; // So the vs knows where to start in the voxel buffer for this object
-
-        // Write the command
-        indirectBuffer->Write(cmd);
-
-        // Write the voxel and mesh data
-        voxelDataBuffer->Write(vertices.data(), vertices.size() * sizeof(Vertex));
-        meshDataBuffer->Write(transform);
-        meshDataBuffer->Write(glm::inverse(transform));
-
-        // Update counters
-        drawCount++;
-        queuedVoxels += vertices.size();
+        const glm::mat4 invTransform = glm::inverse(transform);
+
+        // Whole voxels
+        if (vertices.size() > 0)
+        {
+            if (drawCount == MAX_DRAW_CALLS || queuedVoxels + vertices.size() > MAX_VOXELS) FlushRenderQueue();
+
+            // Sync if necessary
+            if (drawCount == 0) indirectBuffer->Sync();
+
+            // Create indirect command
+            DrawElementsCommand cmd;
+            cmd.count = NUM_CUBE_INDS * vertices.size();
+            cmd.firstIndex = 0;
+            cmd.baseVertex = 0;
+            cmd.instanceCount = 1;
+            cmd.baseInstance = queuedVoxels; // So the vs knows where to start in the voxel buffer for this object
+
+            // Write the command
+            indirectBuffer->Write(cmd);
+
+            // Write the voxel and mesh data
+            voxelDataBuffer->Write(vertices.data(), vertices.size() * sizeof(Vertex));
+            meshDataBuffer->Write(transform);
+            meshDataBuffer->Write(invTransform);
+
+            // Update counters
+            drawCount++;
+            queuedVoxels += vertices.size();
+        }
+
+        // Quads
+        if (quads.size() > 0)
+        {
+            if (quadDrawCount == MAX_DRAW_CALLS || queuedQuads + quads.size() > MAX_QUADS) FlushRenderQueue();
+
+            // Sync if necessary
+            if (quadDrawCount == 0) quadIndirectBuffer->Sync();
+
+            // Create indirect command
+            DrawArraysCommand cmd;
+            cmd.count = NUM_QUAD_VERTS * quads.size();
+            cmd.instanceCount = 1;
+            cmd.first = 0;
+            cmd.baseInstance = queuedQuads; // So the vs knows where to start in the quad buffer for this object
+
+            // Write the command
+            quadIndirectBuffer->Write(cmd);
+
+            // Write the quad and mesh data
+            quadDataBuffer->Write(quads.data(), quads.size() * sizeof(Quad));
+            quadMeshDataBuffer->Write(transform);
+            quadMeshDataBuffer->Write(invTransform);
+
+            // Update counters
+            quadDrawCount++;
+            queuedQuads += quads.size();
+        }
+
+        // All data is streamed every frame, so every change has now been uploaded
+        ClearDirty();
     }
 
     void VoxelMesh::FlushRenderQueue(bool depthPrePass)
     {
-        if (drawCount == 0) return;
+        if (drawCount == 0 && quadDrawCount == 0) return;
 
-        if (depthPrePass)
+        glBindVertexArray(dummyVAO);
+
+        // Whole voxels
+        if (drawCount > 0)
         {
-            depthPassShader->Use();
+            if (depthPrePass)
+            {
+                depthPassShader->Use();
+            }
+            else
+            {
+                geometryPassShader->Use();
+                geometryPassShader->SetUniform("time", (float)glfwGetTime());
+            }
+
+            // Bind resources
+            indexBuffer->Bind(GL_ELEMENT_ARRAY_BUFFER);
+            indirectBuffer->Bind(GL_DRAW_INDIRECT_BUFFER);
+            voxelDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 3, voxelDataBuffer->GetCurrentSection() * voxelDataBuffer->GetSize(), voxelDataBuffer->GetSize());
+            meshDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 4, meshDataBuffer->GetCurrentSection() * meshDataBuffer->GetSize(), meshDataBuffer->GetSize());
+
+            // Issue draw call
+            // NOTE: Culling disabled for mirroring optimization
+            glDisable(GL_CULL_FACE);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(indirectBuffer->GetCurrentSection() * indirectBuffer->GetSize()), drawCount, 0);
+            glEnable(GL_CULL_FACE);
         }
-        else
+
+        // Quads
+        if (quadDrawCount > 0)
         {
-            geometryPassShader->Use();
-            geometryPassShader->SetUniform("time", (float)glfwGetTime());
-        }
+            if (depthPrePass)
+            {
+                quadDepthPassShader->Use();
+            }
+            else
+            {
+                quadGeometryPassShader->Use();
+                quadGeometryPassShader->SetUniform("time", (float)glfwGetTime());
+            }
 
-        // Bind resources
-        glBindVertexArray(dummyVAO);
-        indexBuffer->Bind(GL_ELEMENT_ARRAY_BUFFER);
-        indirectBuffer->Bind(GL_DRAW_INDIRECT_BUFFER);
-        voxelDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 3, voxelDataBuffer->GetCurrentSection() * voxelDataBuffer->GetSize(), voxelDataBuffer->GetSize());
-        meshDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 4, meshDataBuffer->GetCurrentSection() * meshDataBuffer->GetSize(), meshDataBuffer->GetSize());
+            // Bind resources
+            quadIndirectBuffer->Bind(GL_DRAW_INDIRECT_BUFFER);
+            quadDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 3, quadDataBuffer->GetCurrentSection() * quadDataBuffer->GetSize(), quadDataBuffer->GetSize());
+            quadMeshDataBuffer->BindRange(GL_SHADER_STORAGE_BUFFER, 4, quadMeshDataBuffer->GetCurrentSection() * quadMeshDataBuffer->GetSize(), quadMeshDataBuffer->GetSize());
 
-        // Issue draw call
-        // NOTE: Culling disabled for mirroring optimization
-        glDisable(GL_CULL_FACE);
-        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(indirectBuffer->GetCurrentSection() * indirectBuffer->GetSize()), drawCount, 0);
-        glEnable(GL_CULL_FACE);
+            // Issue draw call
+            // NOTE: Quads are wound counter-clockwise when viewed from outside, so back faces are culled
+            glMultiDrawArraysIndirect(GL_TRIANGLES, (void*)(quadIndirectBuffer->GetCurrentSection() * quadIndirectBuffer->GetSize()), quadDrawCount, 0);
+        }
 
         // Unbind
         glBindVertexArray(0);
@@ -189,13 +290,25 @@ namespace Phi
         if (depthPrePass) return;
 
         // Lock buffers
-        indirectBuffer->Lock();
-        indirectBuffer->SwapSections();
-        voxelDataBuffer->SwapSections();
-        meshDataBuffer->SwapSections();
+        if (drawCount > 0)
+        {
+            indirectBuffer->Lock();
+            indirectBuffer->SwapSections();
+            voxelDataBuffer->SwapSections();
+            meshDataBuffer->SwapSections();
+        }
+        if (quadDrawCount > 0)
+        {
+            quadIndirectBuffer->Lock();
+            quadIndirectBuffer->SwapSections();
+            quadDataBuffer->SwapSections();
+            quadMeshDataBuffer->SwapSections();
+        }
         
         // Reset counters
         drawCount = 0;
         queuedVoxels = 0;
+        quadDrawCount = 0;
+        queuedQuads = 0;
     }
 }
\ No newline at end of file
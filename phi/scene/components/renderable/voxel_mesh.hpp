@@ -17,6 +17,7 @@
 namespace Phi
 {
     // A renderable voxel mesh using implicit vertex data generated in the VS
+    // Voxels can be drawn as whole cubes (Vertices()), as quads of merged faces (Quads()), or both
     class VoxelMesh : public BaseComponent
     {
         // Interface
@@ -24,11 +25,39 @@ namespace Phi
 
             // Constants
             static inline const size_t MAX_VOXELS = 1'048'576;
+            static inline const size_t MAX_QUADS = 1'048'576;
 
             // Vertex format
             struct Vertex
             {
                 int16_t x, y, z, material;
+
+                bool operator==(const Vertex&) const = default;
+            };
+
+            // Quad format, a rectangle of coplanar voxel faces
+            struct Quad
+            {
+                // Position of the voxel at the minimum corner of the quad
+                int16_t x, y, z;
+
+                // PBR material ID, or -1 for the fire effect
+                int16_t material;
+
+                // Size in voxels along the face's two tangent axes
+                // For a face along axis a, the tangent axes are (a + 1) % 3 and (a + 2) % 3
+                uint16_t width, height;
+
+                // Face direction: 0 = +X, 1 = -X, 2 = +Y, 3 = -Y, 4 = +Z, 5 = -Z
+                uint16_t face;
+                uint16_t padding = 0;
+            };
+
+            // A range of vertices modified since the last upload
+            struct DirtyRange
+            {
+                size_t first;
+                size_t count;
             };
 
             // Creates an empty voxel mesh
@@ -69,32 +98,72 @@ namespace Phi
             // Data access
 
             // Read-write access to the internal voxel vertex buffer
+            // NOTE: Report changes with MarkDirty() or MarkAllDirty()
             std::vector<Vertex>& Vertices() { return vertices; }
+
+            // Read-write access to the internal quad buffer
+            // NOTE: Report changes with MarkAllDirty()
+            std::vector<Quad>& Quads() { return quads; }
+
+            // Change tracking
+            // Records which vertices were modified since the last upload, so a renderer
+            // that keeps vertex data on the GPU only needs to upload the changed ranges
+
+            // Marks count vertices starting at first as modified
+            // Adjacent ranges are merged, and too many ranges collapse into a full upload
+            void MarkDirty(size_t first, size_t count = 1);
+
+            // Marks every vertex and quad as modified
+            void MarkAllDirty();
+
+            // Returns true if every vertex and quad must be uploaded
+            bool IsAllDirty() const { return allDirty; }
+
+            // Returns the vertex ranges modified since the last upload (only meaningful if !IsAllDirty())
+            // Ranges may extend past the end of the vertex list if it shrank
+            const std::vector<DirtyRange>& GetDirtyRanges() const { return dirtyRanges; }
+
+            // Clears all change tracking, call after uploading
+            void ClearDirty();
         
         // Data / implementation
         private:
 
             // Vertex data
             std::vector<Vertex> vertices;
+            std::vector<Quad> quads;
+
+            // Change tracking
+            static const int MAX_DIRTY_RANGES = 256;
+            std::vector<DirtyRange> dirtyRanges;
+            bool allDirty = true;
 
             // Static mesh resources
             static inline Shader* geometryPassShader = nullptr;
             static inline Shader* depthPassShader = nullptr;
+            static inline Shader* quadGeometryPassShader = nullptr;
+            static inline Shader* quadDepthPassShader = nullptr;
             static inline GLuint dummyVAO = 0;
             static inline GPUBuffer* voxelDataBuffer = nullptr;
             static inline GPUBuffer* meshDataBuffer = nullptr;
             static inline GPUBuffer* indexBuffer = nullptr;
             static inline GPUBuffer* indirectBuffer = nullptr;
+            static inline GPUBuffer* quadDataBuffer = nullptr;
+            static inline GPUBuffer* quadMeshDataBuffer = nullptr;
+            static inline GPUBuffer* quadIndirectBuffer = nullptr;
 
             // Constants
             static const int MAX_DRAW_CALLS = 1024;
             static const int NUM_CUBE_INDS = 18;
             static const int NUM_CUBE_VERTS = 8;
+            static const int NUM_QUAD_VERTS = 6;
 
             // Reference counting for static resources
             static inline size_t refCount = 0;
             static inline int drawCount = 0;
             static inline int queuedVoxels = 0;
+            static inline int quadDrawCount = 0;
+            static inline int queuedQuads = 0;
 
             static void IncreaseReferences();
     };
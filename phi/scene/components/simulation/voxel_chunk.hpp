@@ -35,12 +35,21 @@ namespace Phi
             // Steps the chunk simulation forward by delta seconds
             void Update(float delta);
 
+            // Persistence
+
+            // Marks the chunk's voxels as changed since they were loaded, so the map saves them when the chunk unloads
+            inline void MarkModified() { modified = true; }
+            inline bool IsModified() const { return modified; }
+
         // Data / implementation
         private:
 
             // DEBUG: Grid of voxel material IDs for testing
             Grid3D<int> voxelGrid{CHUNK_DIM, CHUNK_DIM, CHUNK_DIM};
 
+            // Whether the voxels differ from the map's chunk cache
+            bool modified = false;
+
             // Voxel Worlds should have full access to chunk data
             friend class VoxelMap;
     };
@@ -0,0 +1,342 @@
+#include "voxel_chunk_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <phi/core/file.hpp>
+#include <phi/core/logging.hpp>
+#include <phi/scene/components/simulation/voxel_chunk.hpp>
+
+namespace Phi
+{
+    // Region file layout
+    // All values are little-endian
+
+    // Identifies region files
+    static constexpr char REGION_MAGIC[4] = {'P', 'V', 'R', 'G'};
+
+    // Current region format version, increment on any layout change
+    static constexpr uint16_t REGION_VERSION = 1;
+
+    // Region file header, stored at the start of the file
+    struct RegionHeader
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t flags;
+
+        // Region coordinates (chunk ID / REGION_DIM)
+        int32_t region[3];
+    };
+    static_assert(sizeof(RegionHeader) == 20);
+
+    // Location of a chunk record in the file, a size of 0 means the chunk is not cached
+    struct IndexEntry
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+    static_assert(sizeof(IndexEntry) == 8);
+
+    // A run of voxels sharing a palette index
+    struct Run
+    {
+        uint16_t length;
+        uint16_t index;
+    };
+    static_assert(sizeof(Run) == 4);
+
+    static constexpr int REGION_VOLUME = VoxelChunkCache::REGION_DIM * VoxelChunkCache::REGION_DIM * VoxelChunkCache::REGION_DIM;
+    static constexpr int CHUNK_VOLUME = VoxelChunk::CHUNK_DIM * VoxelChunk::CHUNK_DIM * VoxelChunk::CHUNK_DIM;
+    static constexpr size_t INDEX_OFFSET = sizeof(RegionHeader);
+    static constexpr size_t DATA_OFFSET = INDEX_OFFSET + REGION_VOLUME * sizeof(IndexEntry);
+
+    // Splits a chunk ID into its region ID and index within the region
+    static glm::ivec3 GetRegionID(const glm::ivec3& chunkID, int& index)
+    {
+        const glm::ivec3 regionID = glm::ivec3(glm::floor(glm::vec3(chunkID) / (float)VoxelChunkCache::REGION_DIM));
+        const glm::ivec3 local = chunkID - regionID * VoxelChunkCache::REGION_DIM;
+        index = local.x + VoxelChunkCache::REGION_DIM * (local.y + VoxelChunkCache::REGION_DIM * local.z);
+        return regionID;
+    }
+
+    // Returns true if the data begins with a valid header for the given region
+    static bool IsValidRegion(const uint8_t* data, size_t size, const glm::ivec3& regionID)
+    {
+        if (size < DATA_OFFSET) return false;
+
+        RegionHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        return std::memcmp(header.magic, REGION_MAGIC, sizeof(REGION_MAGIC)) == 0 && header.version == REGION_VERSION &&
+               header.region[0] == regionID.x && header.region[1] == regionID.y && header.region[2] == regionID.z;
+    }
+
+    VoxelChunkCache::VoxelChunkCache(const std::string& directory)
+        : directory(directory)
+    {
+        if (!this->directory.empty() && this->directory.back() != '/') this->directory += '/';
+    }
+
+    VoxelChunkCache::~VoxelChunkCache()
+    {
+    }
+
+    bool VoxelChunkCache::Read(const glm::ivec3& chunkID, std::vector<int>& output)
+    {
+        int index;
+        const glm::ivec3 regionID = GetRegionID(chunkID, index);
+
+        // Grab the region's mapping, mapping it on first use
+        std::shared_ptr<MappedFile> region;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // Staged voxels are newer than anything on disk
+            const auto it = staged.find(chunkID);
+            if (it != staged.end())
+            {
+                output = it->second;
+                return true;
+            }
+
+            std::shared_ptr<MappedFile>& mapped = regions[regionID];
+            if (!mapped) mapped = std::make_shared<MappedFile>(GetRegionPath(regionID));
+            region = mapped;
+        }
+        if (!region->IsOpen()) return false;
+
+        // Look up the chunk's record
+        const uint8_t* data = region->GetData();
+        const size_t size = region->GetSize();
+        if (!IsValidRegion(data, size, regionID)) return false;
+
+        IndexEntry entry;
+        std::memcpy(&entry, data + INDEX_OFFSET + index * sizeof(IndexEntry), sizeof(entry));
+        if (entry.size == 0 || entry.offset < DATA_OFFSET || (size_t)entry.offset + entry.size > size) return false;
+
+        return Decode(data + entry.offset, entry.size, output);
+    }
+
+    bool VoxelChunkCache::Write(const glm::ivec3& chunkID, const std::vector<int>& voxels, uint32_t epoch)
+    {
+        if (voxels.size() != CHUNK_VOLUME) return false;
+
+        std::vector<uint8_t> record;
+        Encode(voxels, record);
+
+        // Saved voxels are never replaced, they are newer than anything generated
+        std::lock_guard<std::mutex> lock(mutex);
+        if (epoch != this->epoch || staged.count(chunkID) > 0) return false;
+        return WriteRecord(chunkID, record, false);
+    }
+
+    void VoxelChunkCache::Stage(const glm::ivec3& chunkID, std::vector<int> voxels)
+    {
+        if (voxels.size() != CHUNK_VOLUME) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        staged[chunkID] = std::move(voxels);
+    }
+
+    bool VoxelChunkCache::WriteStaged(const glm::ivec3& chunkID)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Already written by an earlier call (or discarded by Clear())
+        const auto it = staged.find(chunkID);
+        if (it == staged.end()) return true;
+        return WriteStagedEntry(it);
+    }
+
+    bool VoxelChunkCache::WriteAllStaged()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        bool written = true;
+        for (auto it = staged.begin(); it != staged.end();)
+        {
+            // Failed entries are kept, so step past them before the entry may be erased
+            const auto current = it++;
+            written &= WriteStagedEntry(current);
+        }
+        return written;
+    }
+
+    bool VoxelChunkCache::WriteStagedEntry(std::unordered_map<glm::ivec3, std::vector<int>>::iterator it)
+    {
+        const glm::ivec3 chunkID = it->first;
+        std::vector<uint8_t> record;
+        Encode(it->second, record);
+        if (!WriteRecord(chunkID, record, true))
+        {
+            int index;
+            Error("Failed to save chunk (", chunkID.x, ", ", chunkID.y, ", ", chunkID.z, ") to ",
+                  File::GlobalizePath(GetRegionPath(GetRegionID(chunkID, index))));
+            return false;
+        }
+
+        staged.erase(it);
+        return true;
+    }
+
+    bool VoxelChunkCache::WriteRecord(const glm::ivec3& chunkID, const std::vector<uint8_t>& record, bool replace)
+    {
+        int index;
+        const glm::ivec3 regionID = GetRegionID(chunkID, index);
+
+        // Release our mapping of the region before opening it for writing, and remap it on its next read
+        // Readers still holding the old mapping only ever see records that were complete when it was made
+        regions.erase(regionID);
+
+        // Append the record to an existing region file, then point the index at it
+        const std::string path = File::GlobalizePath(GetRegionPath(regionID));
+        std::fstream file(path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        RegionHeader header{};
+        if (file && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            IsValidRegion(reinterpret_cast<const uint8_t*>(&header), DATA_OFFSET, regionID))
+        {
+            IndexEntry entry;
+            file.seekg(INDEX_OFFSET + index * sizeof(IndexEntry));
+            if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry))) return false;
+            if (entry.size != 0 && !replace) return false;
+
+            file.seekp(0, std::ios_base::end);
+            entry = IndexEntry{(uint32_t)file.tellp(), (uint32_t)record.size()};
+            file.write(reinterpret_cast<const char*>(record.data()), record.size());
+            file.seekp(INDEX_OFFSET + index * sizeof(IndexEntry));
+            file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            return (bool)file;
+        }
+        file.close();
+
+        // Otherwise write a new region file holding just this record, and move it into place
+        // Existing files are never truncated, since other readers may still have them mapped
+        std::error_code error;
+        std::filesystem::create_directories(File::GlobalizePath(directory), error);
+
+        std::memcpy(header.magic, REGION_MAGIC, sizeof(REGION_MAGIC));
+        header.version = REGION_VERSION;
+        header.flags = 0;
+        header.region[0] = regionID.x;
+        header.region[1] = regionID.y;
+        header.region[2] = regionID.z;
+        std::vector<IndexEntry> entries(REGION_VOLUME, IndexEntry{0, 0});
+        entries[index] = IndexEntry{(uint32_t)DATA_OFFSET, (uint32_t)record.size()};
+
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream temp(tempPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            temp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            temp.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(IndexEntry));
+            temp.write(reinterpret_cast<const char*>(record.data()), record.size());
+            if (!temp) return false;
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    void VoxelChunkCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        epoch++;
+        regions.clear();
+        staged.clear();
+
+        // Delete region files
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(File::GlobalizePath(directory), error))
+        {
+            if (entry.path().extension() == ".vreg" || entry.path().extension() == ".tmp") std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    uint32_t VoxelChunkCache::GetEpoch()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return epoch;
+    }
+
+    std::string VoxelChunkCache::GetRegionPath(const glm::ivec3& regionID) const
+    {
+        return directory + "r." + std::to_string(regionID.x) + "." + std::to_string(regionID.y) + "." + std::to_string(regionID.z) + ".vreg";
+    }
+
+    void VoxelChunkCache::Encode(const std::vector<int>& voxels, std::vector<uint8_t>& output)
+    {
+        // Build the palette and runs together, chunks rarely hold more than a handful of materials
+        std::vector<int> palette;
+        std::vector<Run> runs;
+        for (int i = 0; i < CHUNK_VOLUME;)
+        {
+            const int material = voxels[i];
+            int length = 1;
+            while (i + length < CHUNK_VOLUME && voxels[i + length] == material) length++;
+            i += length;
+
+            const auto it = std::find(palette.begin(), palette.end(), material);
+            const uint16_t index = it - palette.begin();
+            if (it == palette.end()) palette.push_back(material);
+            runs.push_back({(uint16_t)length, index});
+        }
+
+        // Record layout: uint16_t paletteSize, int32_t palette[paletteSize], uint32_t runCount, Run runs[runCount]
+        const uint16_t paletteSize = palette.size();
+        const uint32_t runCount = runs.size();
+        output.resize(sizeof(paletteSize) + palette.size() * sizeof(int32_t) + sizeof(runCount) + runs.size() * sizeof(Run));
+
+        uint8_t* out = output.data();
+        std::memcpy(out, &paletteSize, sizeof(paletteSize));
+        out += sizeof(paletteSize);
+        for (const int material : palette)
+        {
+            const int32_t value = material;
+            std::memcpy(out, &value, sizeof(value));
+            out += sizeof(value);
+        }
+        std::memcpy(out, &runCount, sizeof(runCount));
+        out += sizeof(runCount);
+        std::memcpy(out, runs.data(), runs.size() * sizeof(Run));
+    }
+
+    bool VoxelChunkCache::Decode(const uint8_t* data, size_t size, std::vector<int>& output)
+    {
+        const uint8_t* end = data + size;
+
+        // Palette
+        uint16_t paletteSize;
+        if (size < sizeof(paletteSize)) return false;
+        std::memcpy(&paletteSize, data, sizeof(paletteSize));
+        data += sizeof(paletteSize);
+        if ((size_t)(end - data) < paletteSize * sizeof(int32_t) + sizeof(uint32_t)) return false;
+        std::vector<int32_t> palette(paletteSize);
+        std::memcpy(palette.data(), data, paletteSize * sizeof(int32_t));
+        data += paletteSize * sizeof(int32_t);
+
+        // Runs
+        uint32_t runCount;
+        std::memcpy(&runCount, data, sizeof(runCount));
+        data += sizeof(runCount);
+        if ((size_t)(end - data) != (size_t)runCount * sizeof(Run)) return false;
+
+        output.resize(CHUNK_VOLUME);
+        int i = 0;
+        for (uint32_t r = 0; r < runCount; ++r)
+        {
+            Run run;
+            std::memcpy(&run, data + r * sizeof(Run), sizeof(run));
+            if (run.index >= paletteSize || i + run.length > CHUNK_VOLUME) return false;
+            std::fill_n(output.begin() + i, run.length, palette[run.index]);
+            i += run.length;
+        }
+
+        return i == CHUNK_VOLUME;
+    }
+}
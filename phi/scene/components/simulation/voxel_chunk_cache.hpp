@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <phi/core/mapped_file.hpp>
+
+namespace Phi
+{
+    // Persistent on-disk storage for the voxels of VoxelMap chunks
+    // Chunks are grouped into region files of REGION_DIM^3 chunks, each file holding:
+    // 1. A header identifying the file and the region it covers
+    // 2. An index of (offset, size) for every chunk in the region, so lookups are O(1)
+    // 3. Chunk records, each a palette of material IDs followed by runs of palette indices (in Grid3D order)
+    // Rewritten chunks are appended and the index entry updated, so old records are left behind as garbage
+    // Region files are never truncated (new ones are written aside and moved into place), so mappings held by readers stay valid
+    // Reads map the region file into memory, and all methods may be called from any thread
+    class VoxelChunkCache
+    {
+        // Interface
+        public:
+
+            // Constants
+            static const int REGION_DIM = 16;
+
+            // Creates a cache that stores region files in the given directory (e.g. "user://voxel_map/")
+            VoxelChunkCache(const std::string& directory);
+            ~VoxelChunkCache();
+
+            // Delete copy constructor/assignment
+            VoxelChunkCache(const VoxelChunkCache&) = delete;
+            VoxelChunkCache& operator=(const VoxelChunkCache&) = delete;
+
+            // Delete move constructor/assignment
+            VoxelChunkCache(VoxelChunkCache&& other) = delete;
+            VoxelChunkCache& operator=(VoxelChunkCache&& other) = delete;
+
+            // Chunk access
+
+            // Reads the voxels of the given chunk into output (CHUNK_DIM^3 values in Grid3D order)
+            // Staged voxels are returned before anything on disk
+            // Returns false if the chunk is not cached or its record is invalid
+            bool Read(const glm::ivec3& chunkID, std::vector<int>& output);
+
+            // Writes the voxels of the given chunk (CHUNK_DIM^3 values in Grid3D order) if it is not already cached or staged
+            // Returns false on failure, or if the chunk was left as it was
+            // This is meant for generated chunks, so a slow generation job can never replace saved edits
+            // Writes made with an epoch from before the last call to Clear() are ignored, so jobs that
+            // started before the cache was cleared can not write stale chunks back into it
+            bool Write(const glm::ivec3& chunkID, const std::vector<int>& voxels, uint32_t epoch);
+
+            // Stages a copy of the chunk's voxels to be written by a later call to WriteStaged()
+            // Until then, Read() returns the staged voxels, so a chunk saved on one thread and reloaded on another
+            // before the write happens never sees an older record
+            void Stage(const glm::ivec3& chunkID, std::vector<int> voxels);
+
+            // Writes the chunk's staged voxels (if any are still staged), returns false on failure
+            // Voxels that fail to write stay staged (so reads still return them) until a later write succeeds
+            bool WriteStaged(const glm::ivec3& chunkID);
+
+            // Writes every chunk's staged voxels, returns false if any failed
+            bool WriteAllStaged();
+
+            // Deletes every region file in the directory, and discards staged voxels
+            void Clear();
+
+            // Accessors
+
+            // Returns the current epoch, to be passed to Write()
+            uint32_t GetEpoch();
+
+            // Returns the directory region files are stored in
+            const std::string& GetDirectory() const { return directory; }
+
+        // Data / implementation
+        private:
+
+            // Directory region files are stored in
+            std::string directory;
+
+            // Guards everything below, and all file writes
+            std::mutex mutex;
+
+            // Voxels waiting to be written by WriteStaged()
+            std::unordered_map<glm::ivec3, std::vector<int>> staged;
+
+            // Mapped region files, including ones that failed to open (so missing regions are not re-opened each read)
+            // Shared so readers can keep using a mapping while a write replaces it
+            std::unordered_map<glm::ivec3, std::shared_ptr<MappedFile>> regions;
+
+            // Incremented by Clear()
+            uint32_t epoch = 0;
+
+            // Writes the staged voxels at it and removes them from staging, or logs an error if the write fails
+            // The mutex must be held
+            bool WriteStagedEntry(std::unordered_map<glm::ivec3, std::vector<int>>::iterator it);
+
+            // Writes an encoded record for the given chunk, replacing an existing record only if replace is set
+            // The mutex must be held
+            bool WriteRecord(const glm::ivec3& chunkID, const std::vector<uint8_t>& record, bool replace);
+
+            // Returns the path to the given region's file
+            std::string GetRegionPath(const glm::ivec3& regionID) const;
+
+            // Encodes / decodes chunk records
+            static void Encode(const std::vector<int>& voxels, std::vector<uint8_t>& output);
+            static bool Decode(const uint8_t* data, size_t size, std::vector<int>& output);
+    };
+}
@@ -1,16 +1,29 @@
 #include "voxel_map.hpp"
 
+#include <algorithm>
+#include <chrono>
+
+#include <phi/core/thread_pool.hpp>
 #include <phi/scene/node.hpp>
 #include <phi/scene/components/lighting/point_light.hpp>
 
 namespace Phi
 {
+    // Returns the squared length of an integer vector
+    static int LengthSquared(const glm::ivec3& v)
+    {
+        return v.x * v.x + v.y * v.y + v.z * v.z;
+    }
+
     VoxelMap::VoxelMap()
     {
     }
 
     VoxelMap::~VoxelMap()
     {
+        // Stop any chunks still being generated
+        CancelChunks();
+
         // Remove ourself from the scene if active
         Scene& scene = GetNode()->GetScene();
         if (scene.GetActiveVoxelMap() == this)
@@ -24,6 +37,50 @@ namespace Phi
         voxelMasses.push_back(volume);
     }
 
+    int VoxelMap::EditSphere(const glm::vec3& centre, float radius, int material)
+    {
+        constexpr int DIM = VoxelChunk::CHUNK_DIM;
+        const Sphere sphere(centre, radius);
+        const glm::ivec3 min = glm::floor(centre - radius);
+        const glm::ivec3 max = glm::ceil(centre + radius);
+
+        // Write the voxels, remembering which chunks changed
+        std::unordered_map<glm::ivec3, VoxelChunk*> editedChunks;
+        int edited = 0;
+        for (int z = min.z; z <= max.z; ++z)
+        {
+            for (int y = min.y; y <= max.y; ++y)
+            {
+                for (int x = min.x; x <= max.x; ++x)
+                {
+                    const glm::ivec3 position(x, y, z);
+                    if (!sphere.Intersects(glm::vec3(position))) continue;
+
+                    // Only loaded chunks can be edited
+                    const glm::ivec3 chunkID = glm::floor(glm::vec3(position) / (float)DIM);
+                    const auto it = loadedChunks.find(chunkID);
+                    if (it == loadedChunks.end()) continue;
+
+                    const glm::ivec3 local = position - chunkID * DIM;
+                    int& voxel = it->second->voxelGrid(local.x, local.y, local.z);
+                    if (voxel == material) continue;
+                    voxel = material;
+                    editedChunks[chunkID] = it->second;
+                    edited++;
+                }
+            }
+        }
+
+        // Each changed chunk is remeshed once, and saved when it unloads
+        for (const auto&[chunkID, chunk] : editedChunks)
+        {
+            chunk->MarkModified();
+            RemeshChunk(chunkID, *chunk);
+        }
+
+        return edited;
+    }
+
     void VoxelMap::Update(float delta)
     {
         // Update loaded chunks if necessary
@@ -34,166 +91,508 @@ namespace Phi
     {
         // Calculate the current chunk
         Camera* camera = GetNode()->GetScene().GetActiveCamera();
-        glm::ivec3 currentChunk = camera->GetPosition() / (float)VoxelChunk::CHUNK_DIM;
+        const glm::ivec3 currentChunk = glm::floor(camera->GetPosition() / (float)VoxelChunk::CHUNK_DIM);
+
+        // The load sphere only changes when the camera crosses a chunk boundary (or the render distance changes)
+        if (loadShellDistance != renderDistance)
+        {
+            BuildLoadShell();
+            rebuildQueue = true;
+        }
+        if (currentChunk != centreChunk) rebuildQueue = true;
 
-        // Create a sphere to check against in chunk space (1 unit = 1 chunk)
-        Sphere loadSphere = Sphere(currentChunk, renderDistance);
+        if (rebuildQueue)
+        {
+            centreChunk = currentChunk;
+            rebuildQueue = false;
+
+            // Create a sphere to check against in chunk space (1 unit = 1 chunk)
+            Sphere loadSphere = Sphere(centreChunk, renderDistance);
+
+            // Queue every chunk in the load shell that is not already loaded or being generated, nearest first
+            chunksToLoad.clear();
+            for (const glm::ivec3& offset : loadShell)
+            {
+                const glm::ivec3 chunkID = centreChunk + offset;
+                if (loadedChunks.count(chunkID) == 0 && pendingChunks.count(chunkID) == 0) chunksToLoad.push_back(chunkID);
+            }
+
+            // Cancel generation of chunks that have left the load sphere
+            for (auto it = pendingChunks.begin(); it != pendingChunks.end();)
+            {
+                if (!loadSphere.Intersects(it->first))
+                {
+                    it->second->cancelled = true;
+                    it = pendingChunks.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
 
-        // Check each chunk in an AABB around the camera
-        // TODO: Could use LUT here for speedup (relative chunk IDs cached for each level of render distance)
-        chunksToLoad.clear();
+            // Unload all chunks that are outside of the new load sphere
+            chunksToUnload.clear();
+            for (const auto&[key, _] : loadedChunks)
+            {
+                if (!loadSphere.Intersects(key)) chunksToUnload.push_back(key);
+            }
+            for (const glm::ivec3& chunkID : chunksToUnload)
+            {
+                ReleaseChunk(chunkID, loadedChunks[chunkID]);
+                loadedChunks.erase(chunkID);
+            }
+        }
+
+        // Add finished chunks to the scene, then keep the workers busy with new ones
+        IntegrateChunks();
+        SubmitChunks(*camera);
+    }
+
+    void VoxelMap::BuildLoadShell()
+    {
+        // Every offset within the render distance, in the same order the load sphere was once scanned
+        loadShell.clear();
+        const Sphere shellSphere = Sphere(glm::vec3(0.0f), renderDistance);
         for (int z = -renderDistance; z <= renderDistance; ++z)
         {
             for (int y = -renderDistance; y <= renderDistance; ++y)
             {
                 for (int x = -renderDistance; x <= renderDistance; ++x)
                 {
-                    // Generate chunk ID
-                    glm::ivec3 chunkID = glm::ivec3(x, y, z) + currentChunk;
-
-                    // Add to queue if within render distance
-                    if (loadSphere.Intersects(chunkID) && loadedChunks.count(chunkID) == 0)
-                    {
-                        chunksToLoad.push_back(chunkID);
-                    }
+                    if (shellSphere.Intersects(glm::vec3(x, y, z))) loadShell.push_back(glm::ivec3(x, y, z));
                 }
             }
         }
 
-        // Unload all chunks that are outside of the new load sphere
-        chunksToUnload.clear();
-        for (const auto&[key, _] : loadedChunks)
+        // Nearest first
+        std::stable_sort(loadShell.begin(), loadShell.end(), [](const glm::ivec3& a, const glm::ivec3& b)
+        {
+            return LengthSquared(a) < LengthSquared(b);
+        });
+        loadShellDistance = renderDistance;
+    }
+
+    void VoxelMap::SubmitChunks(const Camera& camera)
+    {
+        const int slots = std::min((int)chunksToLoad.size(), maxChunkJobs - (int)pendingChunks.size());
+        if (slots <= 0) return;
+
+        // Pick the highest priority chunks (lowest squared distance, scaled up for chunks off screen)
+        // The queue is sorted by distance, so the scan stops once no later chunk could beat the current picks
+        const Frustum frustum = camera.GetViewFrustum();
+        chunkPriorities.clear();
+        for (int i = 0; i < chunksToLoad.size(); ++i)
         {
-            if (!loadSphere.Intersects(key)) chunksToUnload.push_back(key);
+            const float distance = LengthSquared(chunksToLoad[i] - centreChunk);
+            if (chunkPriorities.size() == slots && distance >= chunkPriorities.back().first) break;
+
+            const glm::vec3 min = glm::vec3(chunksToLoad[i] * VoxelChunk::CHUNK_DIM);
+            const bool visible = AABB(min, min + glm::vec3(VoxelChunk::CHUNK_DIM)).IntersectsFast(frustum);
+            const std::pair<float, int> priority = {visible ? distance : distance * OFFSCREEN_PRIORITY, i};
+
+            // Keep the picks sorted by priority
+            if (chunkPriorities.size() == slots && priority >= chunkPriorities.back()) continue;
+            chunkPriorities.insert(std::upper_bound(chunkPriorities.begin(), chunkPriorities.end(), priority), priority);
+            if (chunkPriorities.size() > slots) chunkPriorities.pop_back();
         }
-        for (const glm::ivec3& chunkID : chunksToUnload)
+
+        // Snapshot the masses for this frame's jobs, resolving material IDs on the main thread
+        Scene& scene = GetNode()->GetScene();
+        auto masses = std::make_shared<std::vector<GenerationMass>>();
+        masses->reserve(voxelMasses.size());
+        for (const VoxelMass& mass : voxelMasses)
         {
-            VoxelChunk* chunk = loadedChunks[chunkID];
-            const auto mesh = chunk->GetNode()->Get<VoxelMesh>();
-            if (mesh)
+            // Low frequency noise is sampled on a coarser lattice if the mass allows it
+            int step = 1;
+            if (mass.coarseNoise)
             {
-                voxelsRendered -= mesh->Vertices().size();
+                const float spacing = 1.0f / (glm::max(mass.noise.GetFrequency(), 1e-6f) * NOISE_SAMPLES_PER_WAVELENGTH);
+                while (step < MAX_NOISE_STEP && step * 2 <= spacing) step *= 2;
             }
-            chunk->GetNode()->Delete();
-            loadedChunks.erase(chunkID);
+
+            masses->push_back({scene.GetPBRMaterialID(mass.materialName), mass.volume, mass.noise, step, mass.volume.GetBounds()});
         }
 
-        // DEBUG: Generate one chunk per frame for now
-        // TODO: Use queue system to generate over multiple frames
-        // TODO: Stream from disk if already generated
-        if (chunksToLoad.size() > 0) GenerateChunk(chunksToLoad[0]);
-    }
+        const uint32_t epoch = chunkCache ? chunkCache->GetEpoch() : 0;
+        for (const auto&[_, index] : chunkPriorities)
+        {
+            auto job = std::make_shared<ChunkJob>();
+            job->chunkID = chunksToLoad[index];
 
-    void VoxelMap::GenerateChunk(const glm::ivec3& chunkID)
-    {
-        // TODO: Much optimization needed, naive implementation for testing
+            // Reuse buffers from integrated jobs, their contents are overwritten
+            if (!voxelBuffers.empty())
+            {
+                job->voxels = std::move(voxelBuffers.back());
+                voxelBuffers.pop_back();
+            }
+            if (!vertexBuffers.empty())
+            {
+                job->vertices = std::move(vertexBuffers.back());
+                job->vertices.clear();
+                vertexBuffers.pop_back();
+            }
+            pendingChunks[job->chunkID] = job;
 
-        // TODO: Unload chunk if it currently exists
+            // The job only holds shared state, so it is safe to finish after the map is gone
+            ThreadPool::Instance().Submit([job, masses, cache = chunkCache, epoch, completed = completedChunks]()
+            {
+                // Stream the chunk from disk if it was cached, otherwise generate and cache it
+                job->streamed = cache && cache->Read(job->chunkID, job->voxels);
+                if (!job->streamed)
+                {
+                    GenerateChunk(*job, *masses);
+                    if (job->cancelled) return;
+                    if (cache) cache->Write(job->chunkID, job->voxels, epoch);
+                }
 
-        // Grab the current scene
-        Scene& scene = GetNode()->GetScene();
+                MeshChunk(*job);
+                if (job->cancelled) return;
 
-        // Create the chunk
-        VoxelChunk*& chunk = loadedChunks[chunkID];
-        chunk = &scene.CreateNode()->AddComponent<VoxelChunk>();
+                std::lock_guard<std::mutex> lock(completed->mutex);
+                completed->jobs.push_back(job);
+            });
+        }
 
-        // Mesh data container
-        std::vector<VoxelMesh::Vertex> voxelData;
+        // Remove the submitted (now pending) chunks from the queue, keeping it sorted
+        chunksToLoad.erase(std::remove_if(chunksToLoad.begin(), chunksToLoad.end(), [this](const glm::ivec3& chunkID)
+        {
+            return pendingChunks.count(chunkID) > 0;
+        }), chunksToLoad.end());
+    }
 
-        // Iterate all voxels in the chunk
-        for (int z = 0; z < VoxelChunk::CHUNK_DIM; ++z)
+    void VoxelMap::GenerateChunk(ChunkJob& job, const std::vector<GenerationMass>& masses)
+    {
+        constexpr int DIM = VoxelChunk::CHUNK_DIM;
+        const glm::vec3 origin = glm::vec3(job.chunkID * DIM);
+        job.voxels.assign(DIM * DIM * DIM, 0);
+
+        // Fill each voxel with the material of the last mass that contains it
+        // Volumes are tested against the whole chunk, then against each brick of a partially covered chunk,
+        // so per-voxel intersection tests only happen in bricks that straddle a volume's surface
+        constexpr int BRICKS = DIM / BRICK_DIM;
+        const AABB chunkBox(origin, origin + glm::vec3(DIM - 1));
+        std::vector<float> field(DIM * DIM * DIM);
+        for (const GenerationMass& mass : masses)
         {
-            for (int y = 0; y < VoxelChunk::CHUNK_DIM; ++y)
+            if (job.cancelled) return;
+
+            // Reject masses that miss the chunk entirely
+            if (!mass.bounds.Intersects(chunkBox)) continue;
+            const AggregateVolume::Containment chunkContainment = mass.volume.Classify(chunkBox);
+            if (chunkContainment == AggregateVolume::Containment::Outside) continue;
+
+            // Fully inside, only the noise decides
+            if (chunkContainment == AggregateVolume::Containment::Inside)
             {
-                for (int x = 0; x < VoxelChunk::CHUNK_DIM; ++x)
+                mass.noise.SampleGrid(field.data(), origin, DIM, DIM, DIM, mass.noiseStep);
+                for (int i = 0; i < DIM * DIM * DIM; ++i)
                 {
-                    // TODO: Pre-generation steps?
-
-                    // Get world-space position of this voxel
-                    glm::vec3 position = glm::vec3(x, y, z) + glm::vec3(chunkID * VoxelChunk::CHUNK_DIM);
+                    if (field[i] > 0.0f) job.voxels[i] = mass.material;
+                }
+                continue;
+            }
 
-                    // Check for intersection of each mass
-                    for (auto& mass : voxelMasses)
+            // Partially inside, classify each brick
+            for (int bz = 0; bz < BRICKS; ++bz)
+            {
+                for (int by = 0; by < BRICKS; ++by)
+                {
+                    for (int bx = 0; bx < BRICKS; ++bx)
                     {
-                        if (mass.volume.Intersects(position) && mass.noise.Sample(position) > 0.0f)
+                        const glm::ivec3 brickMin = glm::ivec3(bx, by, bz) * BRICK_DIM;
+                        const glm::vec3 brickOrigin = origin + glm::vec3(brickMin);
+                        const AABB brickBox(brickOrigin, brickOrigin + glm::vec3(BRICK_DIM - 1));
+                        if (!mass.bounds.Intersects(brickBox)) continue;
+                        const AggregateVolume::Containment containment = mass.volume.Classify(brickBox);
+                        if (containment == AggregateVolume::Containment::Outside) continue;
+                        const bool inside = containment == AggregateVolume::Containment::Inside;
+
+                        // The brick's noise lattice lines up with the chunk's, since the step divides the brick size
+                        mass.noise.SampleGrid(field.data(), brickOrigin, BRICK_DIM, BRICK_DIM, BRICK_DIM, mass.noiseStep);
+
+                        int i = 0;
+                        for (int z = 0; z < BRICK_DIM; ++z)
                         {
-                            // This is so insanely slow, obviously
-                            // TODO: Preprocess masses, gather material IDs before iteration
-                            chunk->voxelGrid(x, y, z) = scene.GetPBRMaterialID(mass.materialName);
+                            for (int y = 0; y < BRICK_DIM; ++y)
+                            {
+                                for (int x = 0; x < BRICK_DIM; ++x, ++i)
+                                {
+                                    if (field[i] <= 0.0f) continue;
+
+                                    const glm::ivec3 local = brickMin + glm::ivec3(x, y, z);
+                                    if (inside || mass.volume.Intersects(glm::vec3(local) + origin))
+                                    {
+                                        job.voxels[local.x + DIM * (local.y + DIM * local.z)] = mass.material;
+                                    }
+                                }
+                            }
                         }
                     }
                 }
             }
         }
 
+    }
+
+    void VoxelMap::MeshChunk(ChunkJob& job)
+    {
+        constexpr int DIM = VoxelChunk::CHUNK_DIM;
+        const glm::vec3 origin = glm::vec3(job.chunkID * DIM);
+
+        // Same layout as Grid3D, x varies fastest
+        const auto voxel = [&job](int x, int y, int z) -> int { return job.voxels[x + DIM * (y + DIM * z)]; };
+
         // Add only visible voxels to mesh
-        for (int z = 0; z < VoxelChunk::CHUNK_DIM; ++z)
+        // Border voxels are always visible, since neighbouring chunks are unknown
+        for (int z = 0; z < DIM; ++z)
         {
-            for (int y = 0; y < VoxelChunk::CHUNK_DIM; ++y)
+            if (job.cancelled) return;
+            for (int y = 0; y < DIM; ++y)
             {
-                for (int x = 0; x < VoxelChunk::CHUNK_DIM; ++x)
+                for (int x = 0; x < DIM; ++x)
                 {
-                    const auto& v = chunk->voxelGrid(x, y, z);
+                    const int v = voxel(x, y, z);
                     if (v == 0) continue;
 
-                    // Get world-space position of this voxel
-                    glm::vec3 position = glm::vec3(x, y, z) + glm::vec3(chunkID * VoxelChunk::CHUNK_DIM);
-
-                    if (x == 0 || y == 0 || z == 0 || x == VoxelChunk::CHUNK_DIM - 1 || y == VoxelChunk::CHUNK_DIM - 1 || z == VoxelChunk::CHUNK_DIM - 1)
+                    const bool border = x == 0 || y == 0 || z == 0 || x == DIM - 1 || y == DIM - 1 || z == DIM - 1;
+                    if (border ||
+                        voxel(x - 1, y, z) == 0 ||
+                        voxel(x + 1, y, z) == 0 ||
+                        voxel(x, y - 1, z) == 0 ||
+                        voxel(x, y + 1, z) == 0 ||
+                        voxel(x, y, z - 1) == 0 ||
+                        voxel(x, y, z + 1) == 0)
                     {
-                        VoxelMesh::Vertex vert;
-                        vert.x = position.x;
-                        vert.y = position.y;
-                        vert.z = position.z;
-                        vert.material = v;
-                        voxelData.push_back(vert);
+                        // Get world-space position of this voxel
+                        const glm::vec3 position = glm::vec3(x, y, z) + origin;
 
-                        continue;
-                    }
-                    
-                    if (chunk->voxelGrid(x - 1, y, z) == 0 ||
-                        chunk->voxelGrid(x + 1, y, z) == 0 ||
-                        chunk->voxelGrid(x, y - 1, z) == 0 ||
-                        chunk->voxelGrid(x, y + 1, z) == 0 ||
-                        chunk->voxelGrid(x, y, z - 1) == 0 ||
-                        chunk->voxelGrid(x, y, z + 1) == 0)
-                    {
                         VoxelMesh::Vertex vert;
                         vert.x = position.x;
                         vert.y = position.y;
                         vert.z = position.z;
                         vert.material = v;
-                        voxelData.push_back(vert);
+                        job.vertices.push_back(vert);
                     }
                 }
             }
         }
+    }
+
+    void VoxelMap::IntegrateChunks()
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
 
-        if (voxelData.size() > 0)
+        int integrated = 0;
+        while (integrated == 0 || std::chrono::duration<float, std::milli>(Clock::now() - start).count() < integrationBudget)
         {
-            // DEBUG: Regenerate mesh immediately
+            // Grab the next finished job
+            std::shared_ptr<ChunkJob> job;
+            {
+                std::lock_guard<std::mutex> lock(completedChunks->mutex);
+                if (completedChunks->jobs.empty()) return;
+                job = std::move(completedChunks->jobs.back());
+                completedChunks->jobs.pop_back();
+            }
+
+            // Skip chunks that were cancelled after they finished generating
+            const auto it = pendingChunks.find(job->chunkID);
+            if (job->cancelled || it == pendingChunks.end() || it->second != job) continue;
+            pendingChunks.erase(it);
+
+            // Grab a chunk, reusing a pooled one if possible
+            VoxelChunk* chunk = AcquireChunk();
+            loadedChunks[job->chunkID] = chunk;
+
+            // Copy the generated voxels
+            int i = 0;
+            for (int z = 0; z < VoxelChunk::CHUNK_DIM; ++z)
+            {
+                for (int y = 0; y < VoxelChunk::CHUNK_DIM; ++y)
+                {
+                    for (int x = 0; x < VoxelChunk::CHUNK_DIM; ++x)
+                    {
+                        chunk->voxelGrid(x, y, z) = job->voxels[i++];
+                    }
+                }
+            }
+
+            // Swap the mesh's vertices in, the old (empty) vertex list goes back to the buffer pool
             VoxelMesh* mesh = chunk->GetNode()->Get<VoxelMesh>();
-            if (!mesh) mesh = &chunk->GetNode()->AddComponent<VoxelMesh>();
-            mesh->Vertices() = voxelData;
-            voxelsRendered += voxelData.size();
+            std::swap(mesh->Vertices(), job->vertices);
+            mesh->MarkAllDirty();
+            voxelsRendered += mesh->Vertices().size();
+
+            // Recycle the job's buffers
+            voxelBuffers.push_back(std::move(job->voxels));
+            vertexBuffers.push_back(std::move(job->vertices));
+
+            if (job->streamed) chunksStreamed++;
+            integrated++;
         }
     }
 
-    void VoxelMap::UnloadChunks()
+    VoxelChunk* VoxelMap::AcquireChunk()
     {
-        // Unload all chunks
-        chunksToUnload.clear();
-        for (const auto&[key, _] : loadedChunks)
+        if (!chunkPool.empty())
+        {
+            VoxelChunk* chunk = chunkPool.back();
+            chunkPool.pop_back();
+            poolHits++;
+            return chunk;
+        }
+
+        // Every chunk gets a mesh up front, so pooled chunks keep their vertex storage
+        Node* node = GetNode()->GetScene().CreateNode();
+        node->AddComponent<VoxelMesh>();
+        poolMisses++;
+        return &node->AddComponent<VoxelChunk>();
+    }
+
+    void VoxelMap::ReleaseChunk(const glm::ivec3& chunkID, VoxelChunk* chunk)
+    {
+        if (chunk->IsModified()) SaveChunk(chunkID, *chunk);
+
+        VoxelMesh* mesh = chunk->GetNode()->Get<VoxelMesh>();
+        voxelsRendered -= mesh->Vertices().size();
+
+        // Delete chunks beyond the high-water mark
+        if (chunkPool.size() >= maxPooledChunks)
+        {
+            chunk->GetNode()->Delete();
+            return;
+        }
+
+        // Park the chunk, an empty mesh draws nothing
+        // Voxels are left as they are, since they are overwritten when the chunk is reused
+        mesh->Vertices().clear();
+        mesh->Quads().clear();
+        mesh->MarkAllDirty();
+        chunk->modified = false;
+        chunkPool.push_back(chunk);
+    }
+
+    void VoxelMap::SetMaxPooledChunks(int chunks)
+    {
+        maxPooledChunks = glm::max(chunks, 0);
+        while (chunkPool.size() > maxPooledChunks)
+        {
+            chunkPool.back()->GetNode()->Delete();
+            chunkPool.pop_back();
+        }
+    }
+
+    void VoxelMap::SaveChunk(const glm::ivec3& chunkID, VoxelChunk& chunk)
+    {
+        if (!chunkCache) return;
+
+        // Stage a copy of the voxels now, so the chunk reads back with them even if it reloads before the write,
+        // then write them on a worker thread
+        std::vector<int> voxels;
+        CopyVoxels(chunk, voxels);
+        chunkCache->Stage(chunkID, std::move(voxels));
+        ThreadPool::Instance().Submit([chunkID, cache = chunkCache]()
+        {
+            cache->WriteStaged(chunkID);
+        });
+        chunk.modified = false;
+    }
+
+    bool VoxelMap::SaveChunks()
+    {
+        if (!chunkCache) return true;
+
+        for (const auto&[chunkID, chunk] : loadedChunks)
+        {
+            if (!chunk->IsModified()) continue;
+
+            std::vector<int> voxels;
+            CopyVoxels(*chunk, voxels);
+            chunkCache->Stage(chunkID, std::move(voxels));
+            chunk->modified = false;
+        }
+
+        // Failed writes stay staged, so they are retried by the next save
+        return chunkCache->WriteAllStaged();
+    }
+
+    void VoxelMap::CopyVoxels(VoxelChunk& chunk, std::vector<int>& output)
+    {
+        output.resize(VoxelChunk::CHUNK_DIM * VoxelChunk::CHUNK_DIM * VoxelChunk::CHUNK_DIM);
+        int i = 0;
+        for (int z = 0; z < VoxelChunk::CHUNK_DIM; ++z)
         {
-            VoxelChunk* chunk = loadedChunks[key];
-            const auto mesh = chunk->GetNode()->Get<VoxelMesh>();
-            if (mesh)
+            for (int y = 0; y < VoxelChunk::CHUNK_DIM; ++y)
             {
-                voxelsRendered -= mesh->Vertices().size();
+                for (int x = 0; x < VoxelChunk::CHUNK_DIM; ++x)
+                {
+                    output[i++] = chunk.voxelGrid(x, y, z);
+                }
             }
-            chunk->GetNode()->Delete();
+        }
+    }
+
+    void VoxelMap::RemeshChunk(const glm::ivec3& chunkID, VoxelChunk& chunk)
+    {
+        // Mesh into the chunk's own vertex storage
+        VoxelMesh* mesh = chunk.GetNode()->Get<VoxelMesh>();
+        voxelsRendered -= mesh->Vertices().size();
+
+        ChunkJob job;
+        job.chunkID = chunkID;
+        CopyVoxels(chunk, job.voxels);
+        job.vertices = std::move(mesh->Vertices());
+        job.vertices.clear();
+        MeshChunk(job);
+
+        mesh->Vertices() = std::move(job.vertices);
+        mesh->MarkAllDirty();
+        voxelsRendered += mesh->Vertices().size();
+    }
+
+    void VoxelMap::SetCachePath(const std::string& path)
+    {
+        cachePath = path;
+        chunkCache = path.empty() ? nullptr : std::make_shared<VoxelChunkCache>(path);
+    }
+
+    void VoxelMap::ClearCache()
+    {
+        if (!chunkCache) return;
+
+        // Chunks being streamed from the old cache would be stale
+        CancelChunks();
+        chunkCache->Clear();
+    }
+
+    void VoxelMap::CancelChunks()
+    {
+        // Jobs still in flight see the flag and stop, finished ones are skipped when dequeued
+        for (const auto&[_, job] : pendingChunks)
+        {
+            job->cancelled = true;
+        }
+        pendingChunks.clear();
+        rebuildQueue = true;
+
+        std::lock_guard<std::mutex> lock(completedChunks->mutex);
+        completedChunks->jobs.clear();
+    }
+
+    void VoxelMap::UnloadChunks()
+    {
+        // Discard chunks still being generated, they may be stale
+        CancelChunks();
+
+        // Unload all chunks, saving any that were modified
+        chunksToUnload.clear();
+        for (const auto&[chunkID, chunk] : loadedChunks)
+        {
+            ReleaseChunk(chunkID, chunk);
         }
         loadedChunks.clear();
         chunksToUnload.clear();
+        rebuildQueue = true;
     }
 }
\ No newline at end of file
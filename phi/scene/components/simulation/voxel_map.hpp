@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -9,6 +12,7 @@
 #include <phi/core/math/noise.hpp>
 #include <phi/core/math/shapes.hpp>
 #include <phi/scene/components/simulation/voxel_chunk.hpp>
+#include <phi/scene/components/simulation/voxel_chunk_cache.hpp>
 #include <phi/scene/components/simulation/voxel_object.hpp>
 
 // Forward declaration
@@ -16,6 +20,9 @@ class VoxelMapEditor;
 
 namespace Phi
 {
+    // Forward declarations
+    class Camera;
+
     // A component for loading / simulating voxel terrain and objects
     class VoxelMap : public BaseComponent
     {
@@ -39,6 +46,10 @@ namespace Phi
                 MaterialType materialType{MaterialType::SingleMaterial};
                 AggregateVolume volume;
                 Noise noise;
+
+                // Samples low frequency noise on a coarser lattice and interpolates in between
+                // Much faster, but the interpolated field moves surface voxels slightly, so it is off by default
+                bool coarseNoise = false;
             };
 
             // Creates an empty voxel map
@@ -64,11 +75,60 @@ namespace Phi
             // Gets the list of voxel masses
             std::vector<VoxelMass>& GetVoxelMasses() { return voxelMasses; }
 
+            // Editing
+
+            // Sets every voxel of the loaded chunks within the sphere to the given material (0 clears them)
+            // Edited chunks are remeshed immediately and saved to the cache when they unload
+            // Returns the number of voxels changed
+            int EditSphere(const glm::vec3& centre, float radius, int material);
+
             // Simulation
 
             // Updates the voxel world with the given elapsed time in seconds
             void Update(float delta);
 
+            // Settings
+
+            // Sets the maximum number of chunks being generated on worker threads at once
+            inline void SetMaxChunkJobs(int jobs) { maxChunkJobs = glm::max(jobs, 1); }
+            inline int GetMaxChunkJobs() const { return maxChunkJobs; }
+
+            // Sets the time spent adding generated chunks to the scene per frame, in milliseconds
+            // NOTE: At least one generated chunk is added per frame if any are ready, even if it exceeds the budget
+            inline void SetIntegrationBudget(float milliseconds) { integrationBudget = glm::max(milliseconds, 0.0f); }
+            inline float GetIntegrationBudget() const { return integrationBudget; }
+
+            // Sets the maximum number of unloaded chunks kept for reuse (the pool's high-water mark)
+            // Chunks unloaded while the pool is full are deleted
+            void SetMaxPooledChunks(int chunks);
+            inline int GetMaxPooledChunks() const { return maxPooledChunks; }
+
+            // Statistics
+
+            // Returns the number of chunk loads that reused a pooled chunk, or had to create a new one
+            inline size_t GetPoolHits() const { return poolHits; }
+            inline size_t GetPoolMisses() const { return poolMisses; }
+
+            // Returns the number of unloaded chunks currently kept for reuse
+            inline size_t GetPooledChunkCount() const { return chunkPool.size(); }
+
+            // Persistence
+
+            // Sets the directory chunks are cached in (e.g. "user://voxel_map/"), or an empty path to disable caching
+            // Cached chunks are streamed from disk instead of generated, generated chunks are cached as they are generated,
+            // and chunks marked as modified are saved when they unload
+            void SetCachePath(const std::string& path);
+            inline const std::string& GetCachePath() const { return cachePath; }
+
+            // Deletes every cached chunk, so chunks are generated from the current masses when next loaded
+            // NOTE: Does not affect loaded chunks, call after UnloadChunks() to regenerate everything
+            void ClearCache();
+
+            // Saves every modified loaded chunk (and any earlier save still waiting to be written) on the calling thread
+            // Chunks are otherwise only saved as they unload, so call this before the map is destroyed (e.g. on shutdown)
+            // Returns false if any chunk could not be written
+            bool SaveChunks();
+
         // Data / implementation
         private:
 
@@ -79,15 +139,95 @@ namespace Phi
 
             // TODO: Biomes, features, structures, etc.
 
+            // Copy of a voxel mass used by generation jobs, with its material resolved ahead of time
+            // Workers only ever read these, so edits to the map's masses never race with generation
+            struct GenerationMass
+            {
+                int material;
+                AggregateVolume volume;
+                Noise noise;
+
+                // Spacing of the noise lattice sampled for each chunk
+                int noiseStep;
+
+                // Bounds of the volume, for rejecting chunks before classifying them
+                AABB bounds;
+            };
+
+            // Chunks partially covered by a mass are classified in cubic bricks of this size
+            // Must divide VoxelChunk::CHUNK_DIM
+            static constexpr int BRICK_DIM = 8;
+
+            // Coarse noise (VoxelMass::coarseNoise) is sampled at least this many times per wavelength,
+            // and at most every MAX_NOISE_STEP voxels
+            // MAX_NOISE_STEP must divide BRICK_DIM
+            static constexpr float NOISE_SAMPLES_PER_WAVELENGTH = 8.0f;
+            static constexpr int MAX_NOISE_STEP = 8;
+
+            // A chunk being generated on a worker thread
+            struct ChunkJob
+            {
+                glm::ivec3 chunkID;
+
+                // Set by the main thread when the chunk is no longer wanted, checked by the worker as it goes
+                std::atomic<bool> cancelled{false};
+
+                // Results, only valid once the job is in the completed queue
+                bool streamed = false;
+                std::vector<int> voxels;
+                std::vector<VoxelMesh::Vertex> vertices;
+            };
+
+            // Jobs that have finished generating, waiting to be added to the scene
+            // Lives on the heap so workers that finish after the map is destroyed never touch it
+            struct CompletedChunks
+            {
+                std::mutex mutex;
+                std::vector<std::shared_ptr<ChunkJob>> jobs;
+            };
+
             // Simulation data
 
             // Map of loaded chunks
             std::unordered_map<glm::ivec3, VoxelChunk*> loadedChunks;
 
+            // Map of chunks submitted for generation that have not been loaded yet
+            std::unordered_map<glm::ivec3, std::shared_ptr<ChunkJob>> pendingChunks;
+            std::shared_ptr<CompletedChunks> completedChunks = std::make_shared<CompletedChunks>();
+
+            // Unloaded chunks kept for reuse, each parked on its own node with an empty VoxelMesh
+            std::vector<VoxelChunk*> chunkPool;
+            size_t poolHits = 0;
+            size_t poolMisses = 0;
+
+            // Voxel and vertex buffers of integrated jobs, handed to new jobs so their storage is reused
+            std::vector<std::vector<int>> voxelBuffers;
+            std::vector<std::vector<VoxelMesh::Vertex>> vertexBuffers;
+
+            // On-disk chunk storage, shared with generation jobs (nullptr if caching is disabled)
+            std::string cachePath;
+            std::shared_ptr<VoxelChunkCache> chunkCache;
+
             // Queues
+            // Chunks waiting to be submitted for generation, sorted by distance from the centre chunk
             std::vector<glm::ivec3> chunksToLoad;
             std::vector<glm::ivec3> chunksToUnload;
 
+            // Chunk offsets within the render distance, nearest first
+            std::vector<glm::ivec3> loadShell;
+            int loadShellDistance = -1;
+
+            // The chunk the load queue was built around, and whether it must be rebuilt
+            // The queue is only rebuilt when the camera crosses a chunk boundary, or chunks are cancelled or unloaded
+            glm::ivec3 centreChunk{0};
+            bool rebuildQueue = true;
+
+            // Chunks picked for submission this frame, as (priority, index into chunksToLoad)
+            std::vector<std::pair<float, int>> chunkPriorities;
+
+            // Chunks outside the view frustum are prioritized as if their squared distance was this many times larger
+            static constexpr float OFFSCREEN_PRIORITY = 4.0f;
+
             // Settings
 
             // Whether or not to update / load new chunks around the camera
@@ -96,14 +236,54 @@ namespace Phi
             // The approximate radius (in VoxelChunks) to load around the active camera
             int renderDistance = 6;
 
+            // Generation limits
+            int maxChunkJobs = 8;
+            float integrationBudget = 2.0f;
+            int maxPooledChunks = 128;
+
             // DEBUG: Counters
             size_t voxelsRendered = 0;
+            size_t chunksStreamed = 0;
 
             // Updates which chunks should be loaded / unloaded around the active camera
             void UpdateChunks();
 
-            // Generates the given chunk and loads it into the world
-            void GenerateChunk(const glm::ivec3& chunkID);
+            // Rebuilds the load shell for the current render distance
+            void BuildLoadShell();
+
+            // Submits generation jobs for the highest priority chunks in the load queue, up to the job limit
+            // Nearer chunks go first, and chunks in the camera's view frustum before those outside it
+            void SubmitChunks(const Camera& camera);
+
+            // Generates the voxels of the job's chunk from the given masses
+            // Runs on a worker thread, and returns early if the job is cancelled
+            static void GenerateChunk(ChunkJob& job, const std::vector<GenerationMass>& masses);
+
+            // Builds the mesh of the job's chunk from its voxels
+            // Runs on a worker thread, and returns early if the job is cancelled
+            static void MeshChunk(ChunkJob& job);
+
+            // Adds generated chunks to the scene, within the integration budget
+            void IntegrateChunks();
+
+            // Cancels every pending generation job
+            void CancelChunks();
+
+            // Returns a chunk with a VoxelMesh, from the pool if possible or on a new node otherwise
+            // NOTE: The chunk's voxels are stale and must be overwritten
+            VoxelChunk* AcquireChunk();
+
+            // Saves the chunk if it was modified, then parks it in the pool (or deletes it if the pool is full)
+            void ReleaseChunk(const glm::ivec3& chunkID, VoxelChunk* chunk);
+
+            // Stages a copy of the chunk's voxels in the cache and writes them on a worker thread
+            void SaveChunk(const glm::ivec3& chunkID, VoxelChunk& chunk);
+
+            // Rebuilds the chunk's mesh from its voxels on the calling thread
+            void RemeshChunk(const glm::ivec3& chunkID, VoxelChunk& chunk);
+
+            // Copies the chunk's voxels into output (in Grid3D order)
+            static void CopyVoxels(VoxelChunk& chunk, std::vector<int>& output);
 
             // Unloads all currently loaded chunks
             void UnloadChunks();
@@ -10,4 +10,82 @@ namespace Phi
     VoxelMaterial::~VoxelMaterial()
     {
     }
+
+    void VoxelMaterialTable::Set(int id, const std::string& name, const VoxelMaterial& material)
+    {
+        ids[name] = id;
+        if (id >= Size())
+        {
+            flags.resize(id + 1);
+            flammability.resize(id + 1);
+            density.resize(id + 1);
+            conductivity.resize(id + 1);
+            meltingPoint.resize(id + 1);
+            movement.resize(id + 1);
+            pbrID.resize(id + 1);
+        }
+
+        flags[id] = material.flags;
+        flammability[id] = material.flammability;
+        density[id] = material.density;
+        conductivity[id] = material.conductivity;
+        meltingPoint[id] = material.meltingPoint;
+        pbrID[id] = material.pbrID;
+
+        // Movement follows from the state of matter
+        Move::type move = Move::None;
+        if (material.flags & VoxelMaterial::Flags::Liquid) move |= Move::Fall | Move::Spread;
+        if (material.flags & VoxelMaterial::Flags::Powder) move |= Move::Fall | Move::Slide;
+        if (material.flags & VoxelMaterial::Flags::Gas) move |= Move::Rise | Move::Slide | Move::Diffuse;
+        movement[id] = move;
+    }
+
+    void VoxelMaterialTable::Compile(const std::vector<VoxelMaterial>& materials)
+    {
+        const int count = Size();
+        burnProduct.assign(count, NO_ACTION);
+        burnRate.assign(count, 0.0f);
+        reactive.assign(count, 0);
+        actions.assign((size_t)count * (count + 1), Action());
+
+        for (int id = 0; id < count && id < materials.size(); ++id)
+        {
+            const VoxelMaterial& material = materials[id];
+
+            // Burning out
+            if (!material.burnProduct.empty())
+            {
+                burnProduct[id] = Find(material.burnProduct);
+                burnRate[id] = burnProduct[id] == NO_ACTION ? 0.0f : material.burnRate;
+            }
+
+            // Ignition, each burning neighbour rolls separately
+            // Flammability is scaled so that fire spreads over a few seconds at 60 ticks per second
+            if (material.flammability > 0.0f)
+            {
+                Action& ignite = actions[id * (count + 1) + Burning()];
+                ignite.product = IGNITE;
+                ignite.chance = material.flammability >= 1.0f ? 1.0f : material.flammability / 30.0f;
+            }
+
+            // Reactions
+            for (const VoxelMaterial::Reaction& reaction : material.reactions)
+            {
+                const int neighbour = Find(reaction.neighbour);
+                const int product = Find(reaction.product);
+                if (neighbour == -1 || product == -1) continue;
+
+                Action& action = actions[id * (count + 1) + neighbour];
+                action.product = product;
+                action.chance = reaction.chance;
+                reactive[id] = 1;
+            }
+        }
+    }
+
+    int VoxelMaterialTable::Find(const std::string& name) const
+    {
+        const auto& it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Phi
 {
@@ -25,6 +27,19 @@ namespace Phi
             };
         };
 
+        // A change into another material caused by a neighbouring material
+        struct Reaction
+        {
+            // Name of the neighbouring material that triggers the reaction
+            std::string neighbour;
+
+            // Name of the material this one turns into
+            std::string product;
+
+            // Chance per tick of reacting with each neighbour of the given material
+            float chance = 1.0f;
+        };
+
         VoxelMaterial(const std::string& name = "new_material", Flags::type flags = Flags::None, int pbrID = 0);
         ~VoxelMaterial();
 
@@ -33,9 +48,101 @@ namespace Phi
 
         // Simulation data
         Flags::type flags;
-        float flammability; // 0 = nonflammable, 1 = catches instantly on contact with fire
+        float flammability = 0.0f; // 0 = nonflammable, 1 = catches instantly on contact with fire
+        float density = 1.0f; // Relative to water
+        float conductivity = 0.0f; // 0 = insulator, 1 = perfect thermal conductor
+        float meltingPoint = 0.0f; // 0 = never melts
+
+        // Name of the material a burning voxel turns into, empty = burns forever
+        std::string burnProduct;
+        float burnRate = 0.0f; // Chance per tick that a burning voxel turns into burnProduct
+
+        // Interactions with neighbouring materials
+        std::vector<Reaction> reactions;
 
         // PBR material ID for rendering
         int pbrID;
     };
+
+    // Compact copy of the simulation properties of every voxel material, indexed by material ID
+    // Each property is stored in its own array, so simulation loops only touch the data they read
+    // Maintained by the scene as materials are registered (see Scene::GetVoxelMaterialTable()),
+    // but can be built directly for simulations without a scene
+    // Behaviour is compiled into lookups (movement rules, and a dense (material, neighbour) action table),
+    // so new behaviours are new table entries rather than new branches in the simulation
+    struct VoxelMaterialTable
+    {
+        // Movement rules, compiled from material flags
+        // Liquids fall and spread, powders fall and slide, gases rise, slide, and diffuse
+        struct Move
+        {
+            Move() = delete;
+            typedef uint8_t type;
+            enum : type
+            {
+                None = 0,
+                Fall = 1,          // Move down
+                Rise = 1 << 1,     // Move up
+                Slide = 1 << 2,    // Move diagonally down (or up if rising) when blocked
+                Spread = 1 << 3,   // Move sideways when blocked, if next to another spreading voxel
+                Diffuse = 1 << 4,  // Move sideways when blocked
+            };
+        };
+
+        // Result of a voxel touching a neighbour
+        struct Action
+        {
+            // Material to turn into, or one of the special values below
+            int16_t product = NO_ACTION;
+
+            // Chance per tick (and per neighbour)
+            float chance = 0.0f;
+        };
+
+        // Special action products
+        static constexpr int16_t NO_ACTION = -1;
+        static constexpr int16_t IGNITE = -2;
+
+        // Copies the simulation properties of the given material into the entry for id,
+        // growing the table if necessary, and maps name to id
+        // NOTE: Call Compile() once all materials are set
+        void Set(int id, const std::string& name, const VoxelMaterial& material);
+
+        // Rebuilds every rule that refers to other materials by name
+        // materials[i] must be the material set for ID i, names that are not in the table are ignored
+        void Compile(const std::vector<VoxelMaterial>& materials);
+
+        // Returns the ID of the material with the given name, or -1 if none exists
+        int Find(const std::string& name) const;
+
+        // Returns the number of materials in the table
+        inline size_t Size() const { return flags.size(); }
+
+        // Returns the action for a voxel of the given material touching a voxel of the neighbour material
+        // The neighbour Burning() stands for any burning voxel
+        inline const Action& GetAction(int material, int neighbour) const { return actions[material * (Size() + 1) + neighbour]; }
+
+        // Returns the neighbour column used for burning voxels
+        inline int Burning() const { return Size(); }
+
+        // Identifiers
+        std::unordered_map<std::string, int> ids;
+
+        // Simulation data
+        std::vector<VoxelMaterial::Flags::type> flags;
+        std::vector<float> flammability;
+        std::vector<float> density;
+        std::vector<float> conductivity;
+        std::vector<float> meltingPoint;
+
+        // Compiled rules
+        std::vector<Move::type> movement;
+        std::vector<int16_t> burnProduct;
+        std::vector<float> burnRate;
+        std::vector<uint8_t> reactive; // 1 if the material has any action with a neighbouring material
+        std::vector<Action> actions;   // Size() rows of Size() + 1 columns, see GetAction()
+
+        // PBR material ID for rendering
+        std::vector<int> pbrID;
+    };
 }
\ No newline at end of file
@@ -1,12 +1,24 @@
 #include "voxel_object.hpp"
 
-#include <phi/core/file.hpp>
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+
+#include <phi/core/mapped_file.hpp>
+#include <phi/core/thread_pool.hpp>
 #include <phi/scene/node.hpp>
+#include <phi/scene/components/transform.hpp>
 
 namespace Phi
 {
     VoxelObject::VoxelObject(int width, int height, int depth, const glm::ivec3& offset)
-        : voxelGrid(width, height, depth, -1), offset(offset), flags(Flags::UpdateMesh)
+        : voxelGrid(width, height, depth, -1),
+          occupancyMask(width, height, depth), fallMask(width, height, depth), riseMask(width, height, depth),
+          slideMask(width, height, depth), spreadMask(width, height, depth), diffuseMask(width, height, depth),
+          flammableMask(width, height, depth), burningMask(width, height, depth),
+          decayingMask(width, height, depth), reactiveMask(width, height, depth),
+          offset(offset), flags(Flags::UpdateMesh)
     {
         aabb.min = offset;
         aabb.max = glm::ivec3(width + offset.x, height + offset.y, depth + offset.z);
@@ -16,6 +28,174 @@ namespace Phi
     {
     }
 
+    // Offsets to each face neighbour of a cell
+    static const glm::ivec3 NEIGHBOUR_OFFSETS[6] =
+    {
+        {0, -1, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}, {0, 0, -1}, {0, 0, 1}
+    };
+
+    // Shifts a row word so that each bit holds the value of its -x neighbour
+    // prev is the preceding word of the same row
+    static inline uint64_t FromLower(uint64_t prev, uint64_t word)
+    {
+        return word << 1 | prev >> 63;
+    }
+
+    // Shifts a row word so that each bit holds the value of its +x neighbour
+    // next is the following word of the same row
+    static inline uint64_t FromUpper(uint64_t word, uint64_t next)
+    {
+        return word >> 1 | next << 63;
+    }
+
+    // Returns the Morton (Z-order) key of the given grid space cell
+    // Interleaves the low 21 bits of each coordinate, so cells sharing a brick or region share a range of keys
+    static inline uint64_t MortonKey(int x, int y, int z)
+    {
+        auto spread = [](uint64_t v)
+        {
+            v &= 0x1fffff;
+            v = (v | v << 32) & 0x1f00000000ffffull;
+            v = (v | v << 16) & 0x1f0000ff0000ffull;
+            v = (v | v << 8) & 0x100f00f00f00f00full;
+            v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+            v = (v | v << 2) & 0x1249249249249249ull;
+            return v;
+        };
+        return spread(x) | spread(y) << 1 | spread(z) << 2;
+    }
+
+    // A run of consecutive static voxels along X, [x0, x1), used for island search
+    struct IslandRun
+    {
+        int x0, x1;
+    };
+
+    // Returns the representative of the set containing run i, halving the path on the way
+    static int FindRoot(std::vector<int>& parent, int i)
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Joins the sets containing runs a and b, the lowest index becomes the representative
+    static void Unite(std::vector<int>& parent, int a, int b)
+    {
+        a = FindRoot(parent, a);
+        b = FindRoot(parent, b);
+        if (a < b) parent[b] = a;
+        else if (b < a) parent[a] = b;
+    }
+
+    // Joins every pair of overlapping runs from the rows [a, aEnd) and [b, bEnd) (runs of a row are sorted along X)
+    static void UniteRows(const std::vector<IslandRun>& runs, std::vector<int>& parent, int a, int aEnd, int b, int bEnd)
+    {
+        while (a < aEnd && b < bEnd)
+        {
+            if (runs[a].x0 < runs[b].x1 && runs[b].x0 < runs[a].x1) Unite(parent, a, b);
+            if (runs[a].x1 < runs[b].x1) a++;
+            else b++;
+        }
+    }
+
+    // Order to visit the cells of a 2x2x2 block in (bottom layer first)
+    // Cell index within a block is (dx | dy << 1 | dz << 2)
+    static const int BLOCK_ORDER[8] = {0, 1, 4, 5, 2, 3, 6, 7};
+
+    // Face normals, in the order used by VoxelMesh::Quad::face
+    static const glm::ivec3 FACE_NORMALS[6] =
+    {
+        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+    };
+
+    // A visible voxel face, used for greedy meshing
+    // key holds the face's grid space (column, row, slice) as 16 bit digits, least significant first
+    struct MeshFace
+    {
+        uint64_t key;
+        int16_t material;
+    };
+
+    // Sorts faces by key, using a radix sort over each digit (least significant first)
+    // extents holds the number of distinct values of each digit
+    static void SortFaces(std::vector<MeshFace>& faces, std::vector<MeshFace>& scratch, const int (&extents)[3])
+    {
+        std::vector<int> counts;
+        scratch.resize(faces.size());
+        for (int digit = 0; digit < 3; ++digit)
+        {
+            const int shift = digit * 16;
+            counts.assign(extents[digit] + 1, 0);
+            for (const MeshFace& face : faces) counts[((face.key >> shift) & 0xffff) + 1]++;
+            for (size_t i = 1; i < counts.size(); ++i) counts[i] += counts[i - 1];
+            for (const MeshFace& face : faces) scratch[counts[(face.key >> shift) & 0xffff]++] = face;
+            faces.swap(scratch);
+        }
+    }
+
+    void VoxelObject::SetVoxel(int16_t x, int16_t y, int16_t z, int16_t material)
+    {
+        const Edit edit{x, y, z, material};
+        ApplyEdits({&edit, 1});
+    }
+
+    bool VoxelObject::RemoveVoxel(int16_t x, int16_t y, int16_t z)
+    {
+        const size_t count = voxels.size();
+        const Edit edit{x, y, z, -1};
+        ApplyEdits({&edit, 1});
+        return voxels.size() < count;
+    }
+
+    void VoxelObject::ApplyEdits(std::span<const Edit> edits)
+    {
+        if (edits.empty()) return;
+
+        // Grab relevant data
+        const auto& voxelMaterials = GetMaterials();
+
+        // Apply each edit, tracking how the AABB must change
+        glm::ivec3 placedMin(INT_MAX);
+        glm::ivec3 placedMax(INT_MIN);
+        bool shrink = false;
+        for (const Edit& edit : edits)
+        {
+            const glm::ivec3 position(edit.x, edit.y, edit.z);
+            if (edit.material < 0)
+            {
+                // Only removals on the boundary can shrink the AABB
+                if (EraseVoxel(position - offset, voxelMaterials))
+                {
+                    shrink |= glm::any(glm::equal(position, aabb.min)) || glm::any(glm::equal(position, aabb.max - 1));
+                }
+            }
+            else
+            {
+                PlaceVoxel(position - offset, edit.material, voxelMaterials);
+                placedMin = glm::min(placedMin, position);
+                placedMax = glm::max(placedMax, position + 1);
+            }
+        }
+
+        // Update AABB
+        if (shrink)
+        {
+            RecalculateAABB();
+        }
+        else if (placedMin.x < placedMax.x)
+        {
+            const bool empty = glm::any(glm::greaterThanEqual(aabb.min, aabb.max));
+            aabb.min = empty ? placedMin : glm::min(aabb.min, placedMin);
+            aabb.max = empty ? placedMax : glm::max(aabb.max, placedMax);
+        }
+
+        SortIfNeeded();
+    }
+
     void VoxelObject::Update(float delta)
     {
         // Update timer
@@ -25,250 +205,1018 @@ namespace Phi
         // Reset timer on each successful update
         timeAccum = 0.0f;
 
+        if (IsSimulated()) Step();
+        DetachIslands();
+        RefreshMesh();
+    }
+
+    void VoxelObject::Step()
+    {
+        // Grab relevant data
+        const auto& voxelMaterials = GetMaterials();
+
+        // Alternate the block partition every tick so that each pair
+        // of neighbouring cells shares a block on every other tick
+        const int blockOffset = tick & 1;
+        const glm::ivec3 blockCount = glm::ivec3(
+            voxelGrid.GetWidth() + blockOffset + 1,
+            voxelGrid.GetHeight() + blockOffset + 1,
+            voxelGrid.GetDepth() + blockOffset + 1) / 2;
+
+        // Gather the blocks containing active voxels
+        // Blocks without active voxels can not change, so they are skipped entirely
+        activeBlocks.clear();
+        for (int index : activeVoxels)
+        {
+            // Skip entries left behind by removed voxels
+            if (!activeFlags[index]) continue;
+            activeFlags[index] = 0;
+            const Voxel& voxel = voxels[index];
+            const glm::ivec3 block = (glm::ivec3(voxel.x, voxel.y, voxel.z) - offset + blockOffset) / 2;
+            activeBlocks.push_back(block.x + blockCount.x * (block.y + blockCount.y * block.z));
+        }
+        activeVoxels.clear();
+        std::sort(activeBlocks.begin(), activeBlocks.end());
+        activeBlocks.erase(std::unique(activeBlocks.begin(), activeBlocks.end()), activeBlocks.end());
+
+        // Split the sorted blocks into jobs
+        const int jobCount = (activeBlocks.size() + BLOCKS_PER_JOB - 1) / BLOCKS_PER_JOB;
+        if (jobs.size() < jobCount) jobs.resize(jobCount);
+
+        // The back buffer only needs to be large enough, each block copies the voxels it simulates
+        if (backVoxels.size() < voxels.size()) backVoxels.resize(voxels.size());
+
+        // Simulate all jobs, reading only from the front buffers
+        // Blocks never share cells, so jobs can run in any order (or concurrently) with identical results
+        ThreadPool::Instance().ParallelFor(jobCount, [&](int j)
+        {
+            SimulationJob& job = jobs[j];
+            job.cellWrites.clear();
+            job.changedVoxels.clear();
+            job.awakeVoxels.clear();
+
+            const int first = j * BLOCKS_PER_JOB;
+            const int last = std::min(first + BLOCKS_PER_JOB, (int)activeBlocks.size());
+            for (int b = first; b < last; ++b)
+            {
+                const int id = activeBlocks[b];
+                const glm::ivec3 block = glm::ivec3(id % blockCount.x, (id / blockCount.x) % blockCount.y, id / (blockCount.x * blockCount.y));
+                SimulateBlock(block * 2 - blockOffset, voxelMaterials, job);
+            }
+        }, threadCount);
+
+        // Commit grid changes (blocks never share cells, so order does not matter)
+        for (int j = 0; j < jobCount; ++j)
+        {
+            for (const CellWrite& write : jobs[j].cellWrites)
+            {
+                voxelGrid.Set(write.cell.x, write.cell.y, write.cell.z, write.index);
+                if (write.index == voxelGrid.GetEmptyValue()) UpdateMasks(write.cell, nullptr, voxelMaterials);
+                else unsortedCount++;
+                MarkMeshChange(write.cell);
+            }
+        }
+
+        // Commit voxel changes
+        for (int j = 0; j < jobCount; ++j)
+        {
+            for (int index : jobs[j].changedVoxels)
+            {
+                const bool wasStatic = IsStatic(voxels[index].material, voxelMaterials);
+                const Voxel& voxel = voxels[index] = backVoxels[index];
+                const glm::ivec3 cell = glm::ivec3(voxel.x, voxel.y, voxel.z) - offset;
+                if ((flags & Flags::SplitIslands) && wasStatic && !IsStatic(voxel.material, voxelMaterials)) damagedCells.push_back(cell);
+                UpdateMasks(cell, &voxel, voxelMaterials);
+                MarkMeshChange(cell);
+            }
+        }
+
+        // Update the active set from the new state
+        for (int j = 0; j < jobCount; ++j)
+        {
+            const SimulationJob& job = jobs[j];
+
+            // Voxels that did not change remain active if they still can
+            for (int index : job.awakeVoxels)
+            {
+                const Voxel& voxel = voxels[index];
+                const glm::ivec3 cell = glm::ivec3(voxel.x, voxel.y, voxel.z) - offset;
+                if ((ActiveBits(cell.x >> BitGrid3D::WORD_SHIFT, cell.y, cell.z) >> (cell.x & (BitGrid3D::WORD_BITS - 1))) & 1) Wake(index);
+            }
+
+            // Changed voxels wake their new neighbourhood
+            for (int index : job.changedVoxels)
+            {
+                const Voxel& voxel = voxels[index];
+                WakeNeighbourhood(glm::ivec3(voxel.x, voxel.y, voxel.z) - offset);
+            }
+
+            // Vacated cells wake their neighbourhood
+            for (const CellWrite& write : job.cellWrites)
+            {
+                if (write.index == voxelGrid.GetEmptyValue()) WakeNeighbourhood(write.cell);
+            }
+        }
+
+        // Moved voxels drift out of order, so re-sort once enough have moved
+        SortIfNeeded();
+
+        tick++;
+    }
+
+    void VoxelObject::SimulateBlock(const glm::ivec3& origin, const VoxelMaterialTable& materials, SimulationJob& job)
+    {
         // Flag expansion
-        const bool updateMesh = (flags | Flags::UpdateMesh) == flags;
         const bool simulateFluids = (flags | Flags::SimulateFluids) == flags;
         const bool simulateFire = (flags | Flags::SimulateFire) == flags;
+        const bool simulateReactions = (flags | Flags::SimulateReactions) == flags;
+        const int empty = voxelGrid.GetEmptyValue();
 
-        // Grab relevant data
-        int empty = voxelGrid.GetEmptyValue();
-        const auto& voxelMaterials = GetNode()->GetScene().GetVoxelMaterials();
-
-        // RNG used by the simulation
-        static RNG rng;
+        // Gather the block's cells
+        glm::ivec3 positions[8];
+        bool valid[8];
+        int original[8];
+        int cells[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            positions[i] = origin + glm::ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+            valid[i] = InGrid(positions[i]);
+            original[i] = valid[i] ? voxelGrid.Get(positions[i].x, positions[i].y, positions[i].z) : empty;
+            cells[i] = original[i];
+        }
 
-        // Iterate all voxels
-        for (auto& voxel : voxels)
+        // Simulate each voxel in the block
+        for (int i : BLOCK_ORDER)
         {
-            // Grab material
-            const auto& material = voxelMaterials[voxel.material];
-            const bool isLiquid = (bool)(material.flags & VoxelMaterial::Flags::Liquid);
-            const bool isFire = (bool)(material.flags & VoxelMaterial::Flags::Fire);
-            const bool isOnFire = (bool)(voxel.flags & Voxel::Flags::OnFire);
+            const int index = original[i];
+            if (index == empty) continue;
+
+            // Grab voxel data (current state is read-only, all writes go to the back buffer)
+            const Voxel& voxel = voxels[index];
+            Voxel& next = backVoxels[index] = voxel;
+            const glm::ivec3& position = positions[i];
+            const uint32_t cellID = position.x + voxelGrid.GetWidth() * (position.y + voxelGrid.GetHeight() * position.z);
+            bool changed = false;
+            bool awake = false;
+
+            // Gather neighbour data from the masks, ordered like NEIGHBOUR_OFFSETS
+            // Cells outside of the grid count as occupied, so nothing moves out of bounds
+            const uint32_t occupied = occupancyMask.Neighbours(position.x, position.y, position.z, true);
+            const uint32_t burning = burningMask.Neighbours(position.x, position.y, position.z);
+
+            // Set once the voxel turns into another material, which ends its turn
+            bool transformed = false;
 
             // Fire simulation step
+            // Flammable voxels roll once for each burning neighbour, burning voxels with a burn product roll to burn out
             if (simulateFire)
             {
-                if (isFire || isOnFire)
+                if (burning && flammableMask.Get(position.x, position.y, position.z))
                 {
-                    // Calculate grid position
-                    int gridX = voxel.x - offset.x;
-                    int gridY = voxel.y - offset.y;
-                    int gridZ = voxel.z - offset.z;
-
-                    // Grab current voxel index reference
-                    int& index = voxelGrid(gridX, gridY, gridZ);
-
-                    // Initialize neighbour index pointers
-                    int* pBelow = (voxel.y > aabb.min.y) ? &voxelGrid(gridX, gridY - 1, gridZ) : nullptr;
-                    int* pAbove = (voxel.y < aabb.max.y - 1) ? &voxelGrid(gridX, gridY + 1, gridZ) : nullptr;
-                    int* pLeft = (voxel.x > aabb.min.x) ? &voxelGrid(gridX - 1, gridY, gridZ) : nullptr;
-                    int* pRight = (voxel.x < aabb.max.x - 1) ? &voxelGrid(gridX + 1, gridY, gridZ) : nullptr;
-                    int* pForward = (voxel.z > aabb.min.z) ? &voxelGrid(gridX, gridY, gridZ - 1) : nullptr;
-                    int* pBack = (voxel.z < aabb.max.z - 1) ? &voxelGrid(gridX, gridY, gridZ + 1) : nullptr;
-                    int* pNeighbours[] = { pBelow, pAbove, pLeft, pRight, pForward, pBack };
-
-                    // Iterate all neighbours
-                    for (int i = 0; i < 6; ++i)
+                    // Stay awake while next to fire
+                    awake = true;
+                    const float chance = materials.GetAction(voxel.material, materials.Burning()).chance;
+                    for (uint32_t remaining = burning; remaining; remaining &= remaining - 1)
                     {
-                        int* pNeighbour = pNeighbours[i];
-                        if (pNeighbour && *pNeighbour != empty)
+                        const int n = std::countr_zero(remaining);
+                        if (simulationRNG.NextFloat(cellID, tick, n) < chance)
                         {
-                            // Grab neighbour data
-                            Voxel& vNeighbour = voxels[*pNeighbour];
-                            const float& flammability = voxelMaterials[vNeighbour.material].flammability;
-                            float n = rng.NextFloat(0.0f, 1.0f) * 30;
-                            if (flammability >= 1.0f || n < flammability)
-                            {
-                                // Spread
-                                vNeighbour.flags |= Voxel::Flags::OnFire;
-                                meshDirty = true;
-                            }
+                            // Spread
+                            next.flags |= Voxel::Flags::OnFire;
+                            changed = true;
+                            break;
                         }
                     }
                 }
+                else if (decayingMask.Get(position.x, position.y, position.z))
+                {
+                    // Stay awake until burnt out
+                    awake = true;
+                    if (simulationRNG.NextFloat(cellID, tick, 13) < materials.burnRate[voxel.material])
+                    {
+                        next.material = materials.burnProduct[voxel.material];
+                        next.flags &= ~Voxel::Flags::OnFire;
+                        changed = transformed = true;
+                    }
+                }
+            }
+
+            // Reaction step
+            // Each neighbour whose material has an action with this voxel's material rolls once
+            if (simulateReactions && !transformed && reactiveMask.Get(position.x, position.y, position.z))
+            {
+                for (uint32_t remaining = occupied; remaining; remaining &= remaining - 1)
+                {
+                    const int n = std::countr_zero(remaining);
+                    const glm::ivec3 neighbour = position + NEIGHBOUR_OFFSETS[n];
+                    if (!InGrid(neighbour)) continue;
+
+                    const int other = voxelGrid.Get(neighbour.x, neighbour.y, neighbour.z);
+                    const VoxelMaterialTable::Action& action = materials.GetAction(voxel.material, voxels[other].material);
+                    if (action.product < 0) continue;
+
+                    // Stay awake while next to a reaction partner
+                    awake = true;
+                    if (simulationRNG.NextFloat(cellID, tick, 7 + n) < action.chance)
+                    {
+                        next.material = action.product;
+                        changed = transformed = true;
+                        break;
+                    }
+                }
+            }
+
+            // Movement step
+            // Voxels move along their gravity if possible, otherwise diagonally ahead (Slide), otherwise sideways (Spread, Diffuse)
+            const VoxelMaterialTable::Move::type move = materials.movement[voxel.material];
+            if (simulateFluids && move && !transformed)
+            {
+                // Rising voxels move towards +y, everything else towards -y
+                // Only the far half of the block can move ahead this tick
+                const bool rises = move & VoxelMaterialTable::Move::Rise;
+                const uint32_t aheadBit = rises ? 0b10 : 0b01;
+                const bool canAdvance = rises ? !(i & 2) : (i & 2);
+                const int ahead = i ^ 2;
+
+                // Make decision
+                int possibleMoves[2];
+                int moveCount = 0;
+                if (!(occupied & aheadBit))
+                {
+                    // Always prefer moving straight ahead
+                    awake = true;
+                    if (canAdvance && cells[ahead] == empty) possibleMoves[moveCount++] = ahead;
+                }
+                else
+                {
+                    // Slide diagonally ahead into free cells of this block
+                    if (move & VoxelMaterialTable::Move::Slide)
+                    {
+                        awake = true;
+                        if (canAdvance && valid[ahead ^ 1] && cells[ahead ^ 1] == empty) possibleMoves[moveCount++] = ahead ^ 1;
+                        if (canAdvance && valid[ahead ^ 4] && cells[ahead ^ 4] == empty) possibleMoves[moveCount++] = ahead ^ 4;
+                    }
+
+                    // Otherwise spread sideways into free cells of this block
+                    // Spreading voxels need a spreading neighbour (somewhat mocking cohesion), diffusing voxels do not
+                    const bool sideways = (move & VoxelMaterialTable::Move::Diffuse) ||
+                                          ((move & VoxelMaterialTable::Move::Spread) && spreadMask.Neighbours(position.x, position.y, position.z));
+                    if (moveCount == 0 && sideways)
+                    {
+                        // Stay awake while any side is free
+                        awake |= (~occupied & 0b111100) != 0;
+
+                        // TODO: Prefer adjacent positions over opposite ones (somewhat mocking surface tension)
+                        if (valid[i ^ 1] && cells[i ^ 1] == empty) possibleMoves[moveCount++] = i ^ 1;
+                        if (valid[i ^ 4] && cells[i ^ 4] == empty) possibleMoves[moveCount++] = i ^ 4;
+                    }
+                }
+
+                // Update voxel
+                if (moveCount > 0)
+                {
+                    const int target = possibleMoves[moveCount == 1 ? 0 : simulationRNG.NextFloat(cellID, tick, 6) < 0.5f];
+                    const glm::ivec3 delta = positions[target] - position;
+                    next.x += delta.x;
+                    next.y += delta.y;
+                    next.z += delta.z;
+                    cells[target] = index;
+                    cells[i] = empty;
+                    changed = true;
+                }
+            }
+
+            // Record the outcome
+            if (changed)
+            {
+                job.changedVoxels.push_back(index);
+            }
+            else if (awake)
+            {
+                job.awakeVoxels.push_back(index);
+            }
+        }
+
+        // Queue grid changes
+        for (int i = 0; i < 8; ++i)
+        {
+            if (cells[i] != original[i]) job.cellWrites.push_back({positions[i], cells[i]});
+        }
+    }
+
+    void VoxelObject::PlaceVoxel(const glm::ivec3& cell, int16_t material, const VoxelMaterialTable& materials)
+    {
+        // Initialize voxel data
+        Voxel voxel;
+        voxel.x = cell.x + offset.x;
+        voxel.y = cell.y + offset.y;
+        voxel.z = cell.z + offset.z;
+        voxel.material = material;
+
+        // Place on grid (update existing or push back)
+        const int index = voxelGrid.Get(cell.x, cell.y, cell.z);
+        if (index == voxelGrid.GetEmptyValue())
+        {
+            voxelGrid.Set(cell.x, cell.y, cell.z, voxels.size());
+            voxels.push_back(voxel);
+            meshSlots.push_back(-1);
+            unsortedCount++;
+        }
+        else
+        {
+            // Static voxels that start moving no longer hold anything together
+            if ((flags & Flags::SplitIslands) && IsStatic(voxels[index].material, materials) && !IsStatic(material, materials))
+            {
+                damagedCells.push_back(cell);
+            }
+            voxels[index] = voxel;
+        }
+        UpdateMasks(cell, &voxel, materials);
+        MarkMeshChange(cell);
+
+        // Wake the voxel and its neighbours
+        WakeNeighbourhood(cell);
+    }
+
+    bool VoxelObject::EraseVoxel(const glm::ivec3& cell, const VoxelMaterialTable& materials)
+    {
+        // Clear the cell
+        const int index = voxelGrid.Get(cell.x, cell.y, cell.z);
+        if (index == voxelGrid.GetEmptyValue()) return false;
+        voxelGrid.Set(cell.x, cell.y, cell.z, voxelGrid.GetEmptyValue());
+        UpdateMasks(cell, nullptr, materials);
+        if ((flags & Flags::SplitIslands) && IsStatic(voxels[index].material, materials)) damagedCells.push_back(cell);
+
+        // Swap and pop, patching the grid index of the voxel that moved
+        // Active set entries for the old last index are left behind and skipped by Step()
+        const int last = voxels.size() - 1;
+        if (activeFlags.size() < voxels.size()) activeFlags.resize(voxels.size(), 0);
+        activeFlags[index] = 0;
+        if (index != last)
+        {
+            const Voxel& moved = voxels[index] = voxels[last];
+            voxelGrid.Set(moved.x - offset.x, moved.y - offset.y, moved.z - offset.z, index);
+            unsortedCount++;
+            if (activeFlags[last])
+            {
+                activeFlags[last] = 0;
+                Wake(index);
+            }
+        }
+        voxels.pop_back();
+
+        // Same for mesh slots
+        if (meshSlots[index] != -1) RemoveMeshSlot(index);
+        if (index != last)
+        {
+            meshSlots[index] = meshSlots[last];
+            if (meshSlots[index] != -1) slotVoxels[meshSlots[index]] = index;
+        }
+        meshSlots.pop_back();
+        MarkMeshChange(cell);
+
+        // Neighbours may now be able to move into the cell
+        WakeNeighbourhood(cell);
+        return true;
+    }
+
+    void VoxelObject::SortVoxels()
+    {
+        const int count = voxels.size();
+        unsortedCount = 0;
+
+        // Key each voxel by its grid cell
+        sortKeys.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const Voxel& voxel = voxels[i];
+            sortKeys[i] = MortonKey(voxel.x - offset.x, voxel.y - offset.y, voxel.z - offset.z);
+        }
+
+        // Split the array into a run of voxels still in order and the voxels displaced from it
+        // A voxel is displaced if it is out of order with the run so far or with the voxel after it
+        sortRun.clear();
+        sortDisplaced.clear();
+        uint64_t previous = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const uint64_t key = sortKeys[i];
+            if (key >= previous && (i == count - 1 || key <= sortKeys[i + 1]))
+            {
+                sortRun.push_back(i);
+                previous = key;
+            }
+            else
+            {
+                sortDisplaced.push_back(i);
+            }
+        }
+        if (sortDisplaced.empty()) return;
+
+        // Sort the displaced voxels and merge them back into the run (keys are unique, since cells are)
+        auto byKey = [&](int a, int b) { return sortKeys[a] < sortKeys[b]; };
+        std::sort(sortDisplaced.begin(), sortDisplaced.end(), byKey);
+        sortOrder.resize(count);
+        std::merge(sortRun.begin(), sortRun.end(), sortDisplaced.begin(), sortDisplaced.end(), sortOrder.begin(), byKey);
+
+        // Permute voxel data, using the back buffer as scratch space (it holds nothing between ticks)
+        backVoxels.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            backVoxels[i] = voxels[sortOrder[i]];
+        }
+        voxels.swap(backVoxels);
+
+        // Update grid indices in bulk
+        for (int i = 0; i < count; ++i)
+        {
+            const Voxel& voxel = voxels[i];
+            voxelGrid.Set(voxel.x - offset.x, voxel.y - offset.y, voxel.z - offset.z, i);
+        }
+
+        // Old to new index of each voxel
+        std::vector<int>& remap = sortRun;
+        remap.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            remap[sortOrder[i]] = i;
+        }
+
+        // Remap the active set, dropping entries left behind by removed voxels
+        // Every flagged index has an entry, so every flag is unset after the first pass
+        size_t active = 0;
+        for (int index : activeVoxels)
+        {
+            if (index >= count || !activeFlags[index]) continue;
+            activeFlags[index] = 0;
+            activeVoxels[active++] = remap[index];
+        }
+        activeVoxels.resize(active);
+        for (int index : activeVoxels)
+        {
+            activeFlags[index] = 1;
+        }
+
+        // Remap mesh slots
+        std::vector<int>& slots = sortDisplaced;
+        slots.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            slots[i] = meshSlots[sortOrder[i]];
+        }
+        meshSlots.swap(slots);
+        for (int& index : slotVoxels)
+        {
+            index = remap[index];
+        }
+    }
+
+    const VoxelMaterialTable& VoxelObject::GetMaterials() const
+    {
+        return materialTable ? *materialTable : GetNode()->GetScene().GetVoxelMaterialTable();
+    }
+
+    void VoxelObject::RecalculateAABB()
+    {
+        // Empty objects have an empty AABB at the grid origin
+        if (voxels.empty())
+        {
+            aabb.min = aabb.max = offset;
+            return;
+        }
+
+        aabb.min = glm::ivec3(INT_MAX);
+        aabb.max = glm::ivec3(INT_MIN);
+        for (const Voxel& voxel : voxels)
+        {
+            const glm::ivec3 position(voxel.x, voxel.y, voxel.z);
+            aabb.min = glm::min(aabb.min, position);
+            aabb.max = glm::max(aabb.max, position + 1);
+        }
+    }
+
+    void VoxelObject::UpdateMasks(const glm::ivec3& cell, const Voxel* voxel, const VoxelMaterialTable& materials)
+    {
+        VoxelMaterialTable::Move::type move = VoxelMaterialTable::Move::None;
+        bool flammable = false;
+        bool burning = false;
+        bool decaying = false;
+        bool reactive = false;
+        if (voxel)
+        {
+            const int material = voxel->material;
+            const bool onFire = voxel->flags & Voxel::Flags::OnFire;
+            move = materials.movement[material];
+            burning = onFire || (materials.flags[material] & VoxelMaterial::Flags::Fire);
+            decaying = onFire && materials.burnProduct[material] != VoxelMaterialTable::NO_ACTION;
+            reactive = materials.reactive[material];
+
+            // Only voxels that can still ignite are considered flammable
+            flammable = !onFire && materials.flammability[material] > 0.0f;
+        }
+
+        occupancyMask.Set(cell.x, cell.y, cell.z, voxel);
+        fallMask.Set(cell.x, cell.y, cell.z, move & VoxelMaterialTable::Move::Fall);
+        riseMask.Set(cell.x, cell.y, cell.z, move & VoxelMaterialTable::Move::Rise);
+        slideMask.Set(cell.x, cell.y, cell.z, move & VoxelMaterialTable::Move::Slide);
+        spreadMask.Set(cell.x, cell.y, cell.z, move & VoxelMaterialTable::Move::Spread);
+        diffuseMask.Set(cell.x, cell.y, cell.z, move & VoxelMaterialTable::Move::Diffuse);
+        flammableMask.Set(cell.x, cell.y, cell.z, flammable);
+        burningMask.Set(cell.x, cell.y, cell.z, burning);
+        decayingMask.Set(cell.x, cell.y, cell.z, decaying);
+        reactiveMask.Set(cell.x, cell.y, cell.z, reactive);
+    }
+
+    uint64_t VoxelObject::ActiveBits(int word, int y, int z) const
+    {
+        // Flag expansion
+        const bool simulateFluids = (flags | Flags::SimulateFluids) == flags;
+        const bool simulateFire = (flags | Flags::SimulateFire) == flags;
+        const bool simulateReactions = (flags | Flags::SimulateReactions) == flags;
+        const int lastWord = occupancyMask.GetWordsPerRow() - 1;
+
+        // Cells outside of the grid count as occupied, but never as anything else
+        const uint64_t solid = ~(uint64_t)0;
+        auto occupied = [&](int w, int y, int z)
+        {
+            if (w < 0 || w > lastWord) return solid;
+            return occupancyMask.Row(w, y, z, solid) | ~occupancyMask.ValidBits(w);
+        };
+        auto row = [&](const BitGrid3D& mask, int w, int y, int z)
+        {
+            return w < 0 || w > lastWord ? 0 : mask.Row(w, y, z);
+        };
+
+        // Cells of the row with at least one face neighbour set in the mask
+        auto neighbours = [&](const BitGrid3D& mask)
+        {
+            const uint64_t centre = row(mask, word, y, z);
+            return FromLower(row(mask, word - 1, y, z), centre) | FromUpper(centre, row(mask, word + 1, y, z)) |
+                   row(mask, word, y - 1, z) | row(mask, word, y + 1, z) |
+                   row(mask, word, y, z - 1) | row(mask, word, y, z + 1);
+        };
+
+        // Cells of the row with a free diagonal neighbour in the row dy above
+        auto freeDiagonal = [&](int dy)
+        {
+            const uint64_t ahead = occupied(word, y + dy, z);
+            return ~(FromLower(occupied(word - 1, y + dy, z), ahead) & FromUpper(ahead, occupied(word + 1, y + dy, z)) &
+                     occupied(word, y + dy, z - 1) & occupied(word, y + dy, z + 1));
+        };
+
+        uint64_t result = 0;
+
+        // Flammable voxels with at least one burning neighbour, and burning voxels that burn out
+        if (simulateFire)
+        {
+            result |= row(flammableMask, word, y, z) & neighbours(burningMask);
+            result |= row(decayingMask, word, y, z);
+        }
+
+        // Moving voxels that have somewhere to go (see SimulateBlock())
+        const uint64_t fall = row(fallMask, word, y, z);
+        const uint64_t rise = row(riseMask, word, y, z);
+        const uint64_t spread = row(spreadMask, word, y, z);
+        const uint64_t diffuse = row(diffuseMask, word, y, z);
+        if (simulateFluids && (fall | rise | spread | diffuse))
+        {
+            const uint64_t slide = row(slideMask, word, y, z);
+            const uint64_t occupancy = occupied(word, y, z);
+            const uint64_t freeSide = ~(FromLower(occupied(word - 1, y, z), occupancy) & FromUpper(occupancy, occupied(word + 1, y, z)) &
+                                        occupied(word, y, z - 1) & occupied(word, y, z + 1));
+
+            result |= fall & ~occupied(word, y - 1, z);
+            result |= rise & ~occupied(word, y + 1, z);
+            if (slide & fall) result |= slide & fall & freeDiagonal(-1);
+            if (slide & rise) result |= slide & rise & freeDiagonal(1);
+            if (spread) result |= spread & neighbours(spreadMask) & freeSide;
+            result |= diffuse & freeSide;
+        }
+
+        // Reactive voxels touching any other voxel (the neighbour's material is only checked when simulated)
+        if (simulateReactions)
+        {
+            const uint64_t reactive = row(reactiveMask, word, y, z);
+            if (reactive) result |= reactive & neighbours(occupancyMask);
+        }
+
+        return result & occupancyMask.ValidBits(word);
+    }
+
+    void VoxelObject::Wake(int index)
+    {
+        if (activeFlags.size() < voxels.size()) activeFlags.resize(voxels.size(), 0);
+        if (activeFlags[index]) return;
+        activeFlags[index] = 1;
+        activeVoxels.push_back(index);
+    }
+
+    void VoxelObject::WakeNeighbourhood(const glm::ivec3& cell)
+    {
+        const int empty = voxelGrid.GetEmptyValue();
+
+        // The cell and its X neighbours usually share a row word, so it is only evaluated once
+        int rowWord = -1;
+        uint64_t rowBits = 0;
+
+        // Wake the cell itself and each face neighbour, if they may change
+        for (int n = -1; n < 6; ++n)
+        {
+            const glm::ivec3 neighbour = n < 0 ? cell : cell + NEIGHBOUR_OFFSETS[n];
+            if (!InGrid(neighbour)) continue;
+
+            // Skip empty cells and voxels that are already awake before evaluating the masks
+            const int index = voxelGrid.Get(neighbour.x, neighbour.y, neighbour.z);
+            if (index == empty || (index < activeFlags.size() && activeFlags[index])) continue;
+
+            const int word = neighbour.x >> BitGrid3D::WORD_SHIFT;
+            const bool sameRow = neighbour.y == cell.y && neighbour.z == cell.z;
+            const uint64_t active = (sameRow && word == rowWord) ? rowBits : ActiveBits(word, neighbour.y, neighbour.z);
+            if (sameRow)
+            {
+                rowWord = word;
+                rowBits = active;
+            }
+
+            if ((active >> (neighbour.x & (BitGrid3D::WORD_BITS - 1))) & 1) Wake(index);
+        }
+    }
+
+    void VoxelObject::WakeAll()
+    {
+        // Evaluate whole rows at once, waking only the voxels that may change
+        for (int z = 0; z < voxelGrid.GetDepth(); ++z)
+        {
+            for (int y = 0; y < voxelGrid.GetHeight(); ++y)
+            {
+                for (int word = 0; word < occupancyMask.GetWordsPerRow(); ++word)
+                {
+                    for (uint64_t active = ActiveBits(word, y, z); active; active &= active - 1)
+                    {
+                        const int x = word * BitGrid3D::WORD_BITS + std::countr_zero(active);
+                        Wake(voxelGrid.Get(x, y, z));
+                    }
+                }
             }
+        }
+    }
+
+    int VoxelObject::DetachIslands()
+    {
+        if (damagedCells.empty()) return 0;
 
-            // Fluid simulation step
-            if (simulateFluids && isLiquid)
+        std::vector<std::vector<glm::ivec3>> islands;
+        FindIslands(islands);
+        damagedCells.clear();
+
+        // Objects without a node have nowhere to put islands
+        Node* node = GetNode();
+        if (!node || islands.empty()) return 0;
+
+        const auto& voxelMaterials = GetMaterials();
+        Transform* transform = node->Get<Transform>();
+        std::vector<Edit> removals;
+        for (const std::vector<glm::ivec3>& island : islands)
+        {
+            glm::ivec3 min(INT_MAX);
+            glm::ivec3 max(INT_MIN);
+            for (const glm::ivec3& cell : island)
             {
-                // Calculate grid position
-                int gridX = voxel.x - offset.x;
-                int gridY = voxel.y - offset.y;
-                int gridZ = voxel.z - offset.z;
+                min = glm::min(min, cell);
+                max = glm::max(max, cell);
+            }
+            const glm::ivec3 size = max - min + 1;
+
+            // Create a new object in the same place, with the same settings
+            Node* islandNode = node->GetScene().CreateNode();
+            islandNode->SetName(node->GetName() + " (island)");
+            if (transform) islandNode->AddComponent<Transform>(*transform);
+            if (node->GetParent()) node->GetParent()->AddChild(islandNode);
+
+            VoxelObject& object = islandNode->AddComponent<VoxelObject>(size.x, size.y, size.z, min + offset);
+            object.flags = flags;
+            object.materialTable = materialTable;
+            object.simulationRNG = simulationRNG;
+            object.tick = tick;
+            object.meshMode = meshMode;
+            object.SetTickRate(updatesPerSecond);
+
+            // Move the voxels over, keeping their state
+            for (const glm::ivec3& cell : island)
+            {
+                const Voxel& voxel = voxels[voxelGrid.Get(cell.x, cell.y, cell.z)];
+                const glm::ivec3 islandCell = cell - min;
+                object.PlaceVoxel(islandCell, voxel.material, voxelMaterials);
+
+                Voxel& placed = object.voxels[object.voxelGrid.Get(islandCell.x, islandCell.y, islandCell.z)];
+                placed.flags = voxel.flags;
+                object.UpdateMasks(islandCell, &placed, voxelMaterials);
+                removals.push_back({voxel.x, voxel.y, voxel.z, -1});
+            }
+            object.RecalculateAABB();
+            object.SortIfNeeded();
+        }
+        ApplyEdits(removals);
 
-                // Grab current voxel index reference
-                int& index = voxelGrid(gridX, gridY, gridZ);
+        // Removing whole islands can not disconnect anything else
+        damagedCells.clear();
+        return islands.size();
+    }
 
-                // Initialize neighbour index pointers
-                int* pBelow = (voxel.y > aabb.min.y) ? &voxelGrid(gridX, gridY - 1, gridZ) : nullptr;
-                int* pAbove = (voxel.y < aabb.max.y - 1) ? &voxelGrid(gridX, gridY + 1, gridZ) : nullptr;
-                int* pLeft = (voxel.x > aabb.min.x) ? &voxelGrid(gridX - 1, gridY, gridZ) : nullptr;
-                int* pRight = (voxel.x < aabb.max.x - 1) ? &voxelGrid(gridX + 1, gridY, gridZ) : nullptr;
-                int* pForward = (voxel.z > aabb.min.z) ? &voxelGrid(gridX, gridY, gridZ - 1) : nullptr;
-                int* pBack = (voxel.z < aabb.max.z - 1) ? &voxelGrid(gridX, gridY, gridZ + 1) : nullptr;
-                int* pNeighbours[] = { pBelow, pAbove, pLeft, pRight, pForward, pBack };
+    void VoxelObject::FindIslands(std::vector<std::vector<glm::ivec3>>& islands) const
+    {
+        // Search the bounds of the damage, grown by the margin
+        const glm::ivec3 gridSize(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth());
+        glm::ivec3 lo(INT_MAX);
+        glm::ivec3 hi(INT_MIN);
+        for (const glm::ivec3& cell : damagedCells)
+        {
+            lo = glm::min(lo, cell);
+            hi = glm::max(hi, cell + 1);
+        }
+        lo = glm::max(lo - ISLAND_SEARCH_MARGIN, glm::ivec3(0));
+        hi = glm::min(hi + ISLAND_SEARCH_MARGIN, gridSize);
+        const glm::ivec3 extent = hi - lo;
+        auto rowIndex = [&](int y, int z) { return (y - lo.y) + extent.y * (z - lo.z); };
+
+        // Static voxels in the given word of the row (y, z), restricted to the region
+        auto staticBits = [&](int word, int y, int z)
+        {
+            uint64_t bits = occupancyMask.Row(word, y, z) &
+                            ~(fallMask.Row(word, y, z) | riseMask.Row(word, y, z) | spreadMask.Row(word, y, z) | diffuseMask.Row(word, y, z));
+            const int base = word * BitGrid3D::WORD_BITS;
+            if (base < lo.x) bits &= ~(uint64_t)0 << (lo.x - base);
+            if (hi.x - base < BitGrid3D::WORD_BITS) bits &= ((uint64_t)1 << (hi.x - base)) - 1;
+            return bits;
+        };
 
-                // Pointers to the grid index of each possible move detected
-                int* pMoveInds[6];
-                int possibleMoves = 0;
-                int fluidNeighbours = 0;
+        // The region is split into slabs along Z, one per thread
+        const int slabCount = std::clamp(ThreadPool::Instance().GetWorkerCount() + 1, 1, extent.z);
+        auto slabStart = [&](int slab) { return lo.z + (int)((int64_t)extent.z * slab / slabCount); };
 
-                // Iterate all neighbours
-                for (int i = 0; i < 6; ++i)
+        // Extract the runs of each slab, counting the runs of each row
+        std::vector<std::vector<IslandRun>> slabRuns(slabCount);
+        std::vector<int> rowStart(extent.y * extent.z + 1, 0);
+        ThreadPool::Instance().ParallelFor(slabCount, [&](int slab)
+        {
+            std::vector<IslandRun>& runs = slabRuns[slab];
+            for (int z = slabStart(slab); z < slabStart(slab + 1); ++z)
+            {
+                for (int y = lo.y; y < hi.y; ++y)
                 {
-                    int* pNeighbour = pNeighbours[i];
-                    if (pNeighbour)
+                    const size_t first = runs.size();
+                    for (int word = lo.x >> BitGrid3D::WORD_SHIFT; word <= (hi.x - 1) >> BitGrid3D::WORD_SHIFT; ++word)
                     {
-                        // Grab neighbour data if it exists
-                        Voxel* vNeighbour = *pNeighbour == empty ? nullptr : &voxels[*pNeighbour];
-
-                        // If neighbour exists
-                        if (vNeighbour)
-                        {
-                            // Count fluid neighbours
-                            const auto& neighbourMaterialFlags = voxelMaterials[vNeighbour->material].flags;
-                            fluidNeighbours += (bool)(neighbourMaterialFlags & VoxelMaterial::Flags::Liquid);
-                        }
-                        else
+                        const int base = word * BitGrid3D::WORD_BITS;
+                        for (uint64_t bits = staticBits(word, y, z); bits; )
                         {
-                            // Neighbour does not exist, should we move?
-                            pMoveInds[possibleMoves++] = pNeighbour != pAbove ? pNeighbour : pMoveInds[--possibleMoves];
+                            const int start = std::countr_zero(bits);
+                            const int end = start + std::countr_one(bits >> start);
+                            bits = end < BitGrid3D::WORD_BITS ? bits & (~(uint64_t)0 << end) : 0;
+
+                            // Runs continue across word boundaries
+                            if (runs.size() > first && runs.back().x1 == base + start) runs.back().x1 = base + end;
+                            else runs.push_back({base + start, base + end});
                         }
                     }
+                    rowStart[rowIndex(y, z) + 1] = runs.size() - first;
                 }
+            }
+        });
 
-                // Move if we can
-                if (possibleMoves > 0)
+        // Gather every run, rows are in the same order as slabs
+        std::vector<IslandRun> runs;
+        for (const std::vector<IslandRun>& slab : slabRuns) runs.insert(runs.end(), slab.begin(), slab.end());
+        for (size_t row = 1; row < rowStart.size(); ++row) rowStart[row] += rowStart[row - 1];
+        if (runs.empty()) return;
+
+        // Join runs touching the row below and the row behind
+        // Slabs only touch their own runs, so they are joined in parallel, then across slab boundaries
+        std::vector<int> parent(runs.size());
+        for (int i = 0; i < (int)parent.size(); ++i) parent[i] = i;
+        auto uniteWith = [&](int y, int z, int otherY, int otherZ)
+        {
+            const int row = rowIndex(y, z);
+            const int other = rowIndex(otherY, otherZ);
+            UniteRows(runs, parent, rowStart[row], rowStart[row + 1], rowStart[other], rowStart[other + 1]);
+        };
+        ThreadPool::Instance().ParallelFor(slabCount, [&](int slab)
+        {
+            for (int z = slabStart(slab); z < slabStart(slab + 1); ++z)
+            {
+                for (int y = lo.y; y < hi.y; ++y)
                 {
-                    // Make decision
-                    // TODO: Prefer adjacent positions over opposite ones (somewhat mocking surface tension)
-                    int* pMoveIndex = (pMoveInds[0] == pBelow) ? pMoveInds[0] : (fluidNeighbours > 0) ? pMoveInds[rng.NextInt(0, possibleMoves - 1)] : nullptr;
+                    if (y > lo.y) uniteWith(y, z, y - 1, z);
+                    if (z > slabStart(slab)) uniteWith(y, z, y, z - 1);
+                }
+            }
+        });
+        for (int slab = 1; slab < slabCount; ++slab)
+        {
+            const int z = slabStart(slab);
+            for (int y = lo.y; y < hi.y; ++y) uniteWith(y, z, y, z - 1);
+        }
 
-                    // Update voxel
-                    if (pMoveIndex)
+        // Measure each set, and find the sets that reach the edge of the region (and may continue past it)
+        std::vector<int> size(runs.size(), 0);
+        std::vector<uint8_t> open(runs.size(), 0);
+        bool anyOpen = false;
+        for (int z = lo.z; z < hi.z; ++z)
+        {
+            for (int y = lo.y; y < hi.y; ++y)
+            {
+                const int row = rowIndex(y, z);
+                const bool edgeRow = (y == lo.y && lo.y > 0) || (y == hi.y - 1 && hi.y < gridSize.y) ||
+                                     (z == lo.z && lo.z > 0) || (z == hi.z - 1 && hi.z < gridSize.z);
+                for (int i = rowStart[row]; i < rowStart[row + 1]; ++i)
+                {
+                    const int root = FindRoot(parent, i);
+                    size[root] += runs[i].x1 - runs[i].x0;
+                    if (edgeRow || (runs[i].x0 == lo.x && lo.x > 0) || (runs[i].x1 == hi.x && hi.x < gridSize.x))
                     {
-                        voxel.x += pMoveIndex == pLeft ? -1 : pMoveIndex == pRight ? 1 : 0;
-                        voxel.y += pMoveIndex == pBelow ? -1 : pMoveIndex == pAbove ? 1 : 0;
-                        voxel.z += pMoveIndex == pForward ? -1 : pMoveIndex == pBack ? 1 : 0;
-                        std::swap(*pMoveIndex, index);
-                        meshDirty = true;
+                        open[root] = 1;
+                        anyOpen = true;
                     }
                 }
             }
         }
 
-        if (updateMesh && meshDirty) UpdateMesh();
-    }
-
-    bool VoxelObject::Load(const std::string& path)
-    {
-        // Open the file
-        File file(path, File::Mode::Read);
-        if (file.is_open())
+        // Find the sets next to damage
+        std::vector<uint8_t> damaged(runs.size(), 0);
+        for (const glm::ivec3& cell : damagedCells)
         {
-            // Container for material ids
-            std::vector<int> loadedMaterialIDs;
-            std::vector<Voxel> newVoxels;
+            for (int n = 0; n < 6; ++n)
+            {
+                const glm::ivec3 neighbour = cell + NEIGHBOUR_OFFSETS[n];
+                if (glm::any(glm::lessThan(neighbour, lo)) || glm::any(glm::greaterThanEqual(neighbour, hi))) continue;
 
-            // Material translation access
-            Scene& scene = GetNode()->GetScene();
+                // Runs of a row are sorted, find the one containing the neighbour (if any)
+                const int row = rowIndex(neighbour.y, neighbour.z);
+                const auto last = runs.begin() + rowStart[row + 1];
+                const auto run = std::upper_bound(runs.begin() + rowStart[row], last, neighbour.x,
+                                                  [](int x, const IslandRun& run) { return x < run.x1; });
+                if (run != last && run->x0 <= neighbour.x) damaged[FindRoot(parent, run - runs.begin())] = 1;
+            }
+        }
 
-            // Parse the file
-            std::string line;
-            int phase = 0;
-            bool zAxisVertical = false;
-            glm::ivec3 min(0);
-            glm::ivec3 max(0);
-            while (std::getline(file, line))
+        // If every set is enclosed, the region holds the whole object, so the largest set is the object itself
+        int body = -1;
+        if (!anyOpen)
+        {
+            for (int i = 0; i < (int)runs.size(); ++i)
             {
-                // Ignore comments and empty lines
-                if (line[0] == '#' || line.size() < 1) continue;
-
-                // Setup phase
-                if (line == ".materials")
-                {
-                    phase = 1;
-                    continue;
-                }
-                if (line == ".voxels")
-                {
-                    phase = 2;
-                    continue;
-                }
-                if (line == ".z_axis_vertical") zAxisVertical = true;
+                if (parent[i] == i && (body == -1 || size[i] > size[body])) body = i;
+            }
+        }
 
-                // Material parsing
-                if (phase == 1)
-                {
-                    // Parse index
-                    int id;
-                    std::istringstream(line) >> id;
+        // Every enclosed set next to damage is an island
+        std::vector<int> islandOf(runs.size(), -1);
+        for (int i = 0; i < (int)runs.size(); ++i)
+        {
+            if (parent[i] == i && damaged[i] && !open[i] && i != body)
+            {
+                islandOf[i] = islands.size();
+                islands.emplace_back();
+            }
+        }
+        if (islands.empty()) return;
 
-                    // Extract the name and load the proper ID for it
-                    std::string name = line.substr(line.find_first_of(':') + 2);
-                    loadedMaterialIDs.push_back(scene.GetVoxelMaterialID(name));
-                }
-                
-                // Voxel data parsing
-                if (phase == 2)
+        for (int z = lo.z; z < hi.z; ++z)
+        {
+            for (int y = lo.y; y < hi.y; ++y)
+            {
+                const int row = rowIndex(y, z);
+                for (int i = rowStart[row]; i < rowStart[row + 1]; ++i)
                 {
-                    // Parse the voxel data
-                    Voxel voxel;
-
-                    if (zAxisVertical)
-                    {
-                        std::istringstream(line) >> voxel.x >> voxel.z >> voxel.y >> voxel.material;
-                    }
-                    else
-                    {
-                        std::istringstream(line) >> voxel.x >> voxel.y >> voxel.z >> voxel.material;
-                    }
-
-                    // Translate to the currently loaded ID
-                    voxel.material = loadedMaterialIDs[voxel.material];
-                    
-                    // Update min and max coords
-                    // TODO: Safety loading empty models?
-                    min.x = voxel.x < min.x ? voxel.x : min.x;
-                    min.y = voxel.y < min.y ? voxel.y : min.y;
-                    min.z = voxel.z < min.z ? voxel.z : min.z;
-                    max.x = voxel.x > max.x ? voxel.x : max.x;
-                    max.y = voxel.y > max.y ? voxel.y : max.y;
-                    max.z = voxel.z > max.z ? voxel.z : max.z;
-
-                    // Add to voxel data
-                    newVoxels.emplace_back(voxel);
+                    const int island = islandOf[FindRoot(parent, i)];
+                    if (island == -1) continue;
+                    for (int x = runs[i].x0; x < runs[i].x1; ++x) islands[island].push_back({x, y, z});
                 }
             }
-            
-            // Update all internal voxel data
-            voxelGrid.Resize(max.x - min.x + 1, max.y - min.y + 1, max.z - min.z + 1);
-            offset = min;
-            for (const auto& voxel : newVoxels)
+        }
+    }
+
+    bool VoxelObject::Load(const std::string& path)
+    {
+        // Binary files are used in place through a memory mapping
+        MappedFile mappedFile(path);
+        if (mappedFile.IsOpen() && VoxelObjectFormat::IsBinary(mappedFile.GetData(), mappedFile.GetSize()))
+        {
+            // Validate the file before touching any voxel data
+            std::string error;
+            const uint8_t* data = mappedFile.GetData();
+            const VoxelObjectFormat::Header* header = VoxelObjectFormat::ValidateBinary(data, mappedFile.GetSize(), error);
+            if (!header)
             {
-                SetVoxel(voxel.x, voxel.y, voxel.z, voxel.material);
+                Error("Invalid voxel object file: ", mappedFile.GetGlobalPath(), " (", error, ")");
+                return false;
             }
 
-            UpdateMesh();
-
-            // Update AABB
-            aabb.min = min;
-            aabb.max = max + 1;
+            const glm::ivec3 min(header->min[0], header->min[1], header->min[2]);
+            const glm::ivec3 max(header->max[0], header->max[1], header->max[2]);
+            LoadRecords(VoxelObjectFormat::ReadMaterials(data), {VoxelObjectFormat::GetRecords(data), header->voxelCount}, min, max);
             return true;
         }
-        else
+
+        // Otherwise parse the mapped text in place
+        if (!mappedFile.IsOpen())
         {
             // Give an error message and return
-            Error("File could not be opened: ", file.GetGlobalPath());
+            Error("File could not be opened: ", mappedFile.GetGlobalPath());
+            return false;
+        }
+
+        VoxelObjectFormat::Model model;
+        if (!VoxelObjectFormat::ParseText((const char*)mappedFile.GetData(), mappedFile.GetSize(), model))
+        {
+            Error("Invalid voxel object file: ", mappedFile.GetGlobalPath());
             return false;
         }
+
+        LoadRecords(model.materials, model.records, model.min, model.max);
+        return true;
+    }
+
+    void VoxelObject::LoadRecords(const std::vector<std::string>& materialNames, std::span<const VoxelObjectFormat::Record> records,
+                                  const glm::ivec3& min, const glm::ivec3& max)
+    {
+        // Translate file material indices to the currently loaded IDs (unknown names use the default material)
+        const auto& voxelMaterials = GetMaterials();
+        std::vector<int16_t> materialIDs;
+        materialIDs.reserve(materialNames.size());
+        for (const std::string& name : materialNames)
+        {
+            materialIDs.push_back(std::max(voxelMaterials.Find(name), 0));
+        }
+
+        // Update all internal voxel data
+        const glm::ivec3 size = max - min + 1;
+        voxelGrid.Resize(size.x, size.y, size.z);
+        occupancyMask.Resize(size.x, size.y, size.z);
+        fallMask.Resize(size.x, size.y, size.z);
+        riseMask.Resize(size.x, size.y, size.z);
+        slideMask.Resize(size.x, size.y, size.z);
+        spreadMask.Resize(size.x, size.y, size.z);
+        diffuseMask.Resize(size.x, size.y, size.z);
+        flammableMask.Resize(size.x, size.y, size.z);
+        burningMask.Resize(size.x, size.y, size.z);
+        decayingMask.Resize(size.x, size.y, size.z);
+        reactiveMask.Resize(size.x, size.y, size.z);
+        voxels.clear();
+        voxels.reserve(records.size());
+        activeVoxels.clear();
+        activeFlags.clear();
+        meshSlots.clear();
+        meshSlots.reserve(records.size());
+        slotVoxels.clear();
+        meshChanges.clear();
+        meshDirty = true;
+        unsortedCount = 0;
+        damagedCells.clear();
+        offset = min;
+
+        for (const VoxelObjectFormat::Record& record : records)
+        {
+            PlaceVoxel(glm::ivec3(record.x, record.y, record.z) - offset, materialIDs[record.material], voxelMaterials);
+        }
+
+        // Voxels are placed in file order
+        SortIfNeeded();
+
+        UpdateMesh();
+
+        // Update AABB
+        aabb.min = min;
+        aabb.max = max + 1;
     }
 
     void VoxelObject::Reset()
     {
         voxelGrid.Clear();
-        if (mesh) mesh->Vertices().clear();
+        occupancyMask.Clear();
+        fallMask.Clear();
+        riseMask.Clear();
+        slideMask.Clear();
+        spreadMask.Clear();
+        diffuseMask.Clear();
+        flammableMask.Clear();
+        burningMask.Clear();
+        decayingMask.Clear();
+        reactiveMask.Clear();
+        voxels.clear();
+        activeVoxels.clear();
+        activeFlags.clear();
+        meshChanges.clear();
+        meshSlots.clear();
+        slotVoxels.clear();
+        unsortedCount = 0;
+        damagedCells.clear();
+        if (mesh)
+        {
+            mesh->Vertices().clear();
+            mesh->Quads().clear();
+            mesh->MarkAllDirty();
+        }
     }
 
     VoxelObject::RaycastInfo VoxelObject::Raycast(const Ray& ray, int maxSteps)
@@ -278,8 +1226,9 @@ namespace Phi
         // Create a copy of the ray since we have to offset it
         Ray r = ray;
 
-        // Determine intersection with object
-        glm::vec2 tNearFar = r.Slabs(aabb);
+        // Determine intersection with the grid (empty cells are visited too, so the AABB is not enough)
+        const IAABB bounds(offset, offset + glm::ivec3(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth()));
+        glm::vec2 tNearFar = r.Slabs(bounds);
         if (tNearFar.x < tNearFar.y)
         {
             // Calculate starting position (with fractional component)
@@ -288,9 +1237,9 @@ namespace Phi
             // Calculate step directions
             glm::ivec3 step = glm::ivec3(glm::sign(r.direction.x), glm::sign(r.direction.y), glm::sign(r.direction.z));
 
-            // Calculate starting and ending voxel
+            // Calculate starting voxel, and the first voxel past the grid along each axis
             glm::ivec3 xyz = glm::floor(start);
-            glm::ivec3 oob = glm::floor(r.origin + r.direction * tNearFar.y);
+            glm::ivec3 oob = glm::mix(offset - 1, bounds.max, glm::greaterThan(step, glm::ivec3(0)));
 
             // Avoid infinite loop
             if (step == glm::ivec3(0))
@@ -300,10 +1249,11 @@ namespace Phi
             }
 
             // Calculate tMax and tDelta
+            // NOTE: The start is usually on a cell boundary, which is still a whole cell away when stepping up
             glm::vec3 tMax;
-            tMax.x = (r.direction.x > 0 ? glm::ceil(start.x) - start.x : start.x - glm::floor(start.x)) / glm::abs(r.direction.x);
-            tMax.y = (r.direction.y > 0 ? glm::ceil(start.y) - start.y : start.y - glm::floor(start.y)) / glm::abs(r.direction.y);
-            tMax.z = (r.direction.z > 0 ? glm::ceil(start.z) - start.z : start.z - glm::floor(start.z)) / glm::abs(r.direction.z);
+            tMax.x = (r.direction.x > 0 ? glm::floor(start.x) + 1.0f - start.x : start.x - glm::floor(start.x)) / glm::abs(r.direction.x);
+            tMax.y = (r.direction.y > 0 ? glm::floor(start.y) + 1.0f - start.y : start.y - glm::floor(start.y)) / glm::abs(r.direction.y);
+            tMax.z = (r.direction.z > 0 ? glm::floor(start.z) + 1.0f - start.z : start.z - glm::floor(start.z)) / glm::abs(r.direction.z);
             
             glm::vec3 tDelta = glm::vec3(step) / r.direction;
 
@@ -325,7 +1275,7 @@ namespace Phi
                     gridXYZ.z < voxelGrid.GetDepth())
                 {
                     // Check for voxel at current position
-                    int& index = voxelGrid(gridXYZ.x, gridXYZ.y, gridXYZ.z);
+                    const int index = voxelGrid.Get(gridXYZ.x, gridXYZ.y, gridXYZ.z);
 
                     if (index != voxelGrid.GetEmptyValue())
                     {
@@ -383,8 +1333,296 @@ namespace Phi
         return std::move(result);
     }
 
+    VoxelObject::RaycastHit VoxelObject::RaycastFirst(const Ray& ray, float maxDistance) const
+    {
+        RaycastHit result;
+        RayTraversal traversal;
+        if (BeginTraversal(ray, traversal))
+        {
+            while (StepTraversal(traversal, maxDistance, result));
+        }
+        return result;
+    }
+
+    void VoxelObject::RaycastBatch(std::span<const Ray> rays, std::span<RaycastHit> hits, float maxDistance) const
+    {
+        const int rayCount = std::min(rays.size(), hits.size());
+        const int packetCount = (rayCount + RAYS_PER_PACKET - 1) / RAYS_PER_PACKET;
+        const int jobCount = (packetCount + PACKETS_PER_JOB - 1) / PACKETS_PER_JOB;
+
+        // Rays only read the grid, and each job writes its own run of hits, so jobs can run concurrently
+        // Small batches fit in a single job and are traced on the calling thread
+        ThreadPool::Instance().ParallelFor(jobCount, [&](int j)
+        {
+            const int lastPacket = std::min((j + 1) * PACKETS_PER_JOB, packetCount);
+            for (int p = j * PACKETS_PER_JOB; p < lastPacket; ++p)
+            {
+                const int first = p * RAYS_PER_PACKET;
+                const int lanes = std::min(RAYS_PER_PACKET, rayCount - first);
+                TracePacket(rays.subspan(first, lanes), hits.subspan(first, lanes), maxDistance);
+            }
+        });
+    }
+
+    void VoxelObject::TracePacket(std::span<const Ray> rays, std::span<RaycastHit> hits, float maxDistance) const
+    {
+        const glm::ivec3 size(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth());
+
+        // Set up each lane, rays that miss the grid entirely are never stepped
+        // Unused lanes hold a harmless ray, since the step loop computes every lane
+        RayPacket packet;
+        uint32_t active = 0;
+        for (int lane = 0; lane < RAYS_PER_PACKET; ++lane)
+        {
+            RayTraversal traversal;
+            if (lane < rays.size())
+            {
+                hits[lane] = RaycastHit();
+                if (BeginTraversal(rays[lane], traversal)) active |= 1u << lane;
+            }
+            if (!(active & (1u << lane)))
+            {
+                traversal.ray = Ray(glm::vec3(0.5f), glm::vec3(1.0f));
+                traversal.invDirection = glm::vec3(1.0f);
+                traversal.cell = glm::ivec3(0);
+                traversal.normal = glm::ivec3(0);
+                traversal.t = 0.0f;
+            }
+
+            for (int i = 0; i < 3; ++i)
+            {
+                packet.origin[i][lane] = traversal.ray.origin[i];
+                packet.direction[i][lane] = traversal.ray.direction[i];
+                packet.invDirection[i][lane] = traversal.invDirection[i];
+                packet.positive[i][lane] = traversal.ray.direction[i] > 0.0f ? -1 : 0;
+                packet.cell[i][lane] = traversal.cell[i];
+                if (traversal.normal[i] != 0) packet.axis[lane] = i;
+            }
+            if (traversal.normal == glm::ivec3(0)) packet.axis[lane] = -1;
+            packet.blockSize[lane] = 1;
+            packet.t[lane] = traversal.t;
+        }
+
+        while (active)
+        {
+            // Find the largest empty block containing each lane's cell (or stop the lane at a voxel)
+            // Lookups are scattered through the grid, so lanes are visited one at a time
+            for (uint32_t remaining = active; remaining; remaining &= remaining - 1)
+            {
+                const int lane = std::countr_zero(remaining);
+                const int x = packet.cell[0][lane];
+                const int y = packet.cell[1][lane];
+                const int z = packet.cell[2][lane];
+                if (packet.t[lane] > maxDistance)
+                {
+                    active &= ~(1u << lane);
+                }
+                else if (voxelGrid.IsRegionEmpty(x, y, z))
+                {
+                    packet.blockSize[lane] = BrickGrid3D<int>::REGION_SIZE;
+                }
+                else if (voxelGrid.IsBrickEmpty(x, y, z))
+                {
+                    packet.blockSize[lane] = BrickGrid3D<int>::BRICK_SIZE;
+                }
+                else
+                {
+                    packet.blockSize[lane] = 1;
+                    const int index = voxelGrid.Get(x, y, z);
+                    if (index != voxelGrid.GetEmptyValue())
+                    {
+                        RaycastHit& hit = hits[lane];
+                        hit.voxel = voxels[index];
+                        const int axis = packet.axis[lane];
+                        if (axis >= 0) hit.normal[axis] = packet.positive[axis][lane] ? -1 : 1;
+                        hit.distance = packet.t[lane];
+                        hit.hit = true;
+                        active &= ~(1u << lane);
+                    }
+                }
+            }
+
+            // Step every lane to the face it leaves its block through, without branches so the loop runs across lanes
+            // Finished lanes are stepped too, but their results are never read
+            for (int lane = 0; lane < RAYS_PER_PACKET; ++lane)
+            {
+                const int blockSize = packet.blockSize[lane];
+                int blockMin[3];
+                int blockMax[3];
+                float tPlane[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    blockMin[i] = packet.cell[i][lane] & ~(blockSize - 1);
+                    blockMax[i] = std::min(blockMin[i] + blockSize, size[i]);
+                    const float bound = (float)(packet.positive[i][lane] ? blockMax[i] : blockMin[i]);
+                    tPlane[i] = packet.direction[i][lane] == 0.0f ? INFINITY : (bound - packet.origin[i][lane]) * packet.invDirection[i][lane];
+                }
+
+                // Earlier axes win ties, as in StepTraversal()
+                const float tXY = tPlane[1] < tPlane[0] ? tPlane[1] : tPlane[0];
+                const int axisXY = tPlane[1] < tPlane[0] ? 1 : 0;
+                const float tExit = tPlane[2] < tXY ? tPlane[2] : tXY;
+                const int axis = tPlane[2] < tXY ? 2 : axisXY;
+
+                // The exit axis moves exactly one cell past the block, the others stay within it
+                // Truncating matches flooring here, since blocks never extend below zero
+                for (int i = 0; i < 3; ++i)
+                {
+                    const float exit = packet.origin[i][lane] + packet.direction[i][lane] * tExit;
+                    const int within = std::clamp((int)exit, blockMin[i], blockMax[i] - 1);
+                    const int past = packet.positive[i][lane] ? blockMax[i] : blockMin[i] - 1;
+                    packet.cell[i][lane] = i == axis ? past : within;
+                }
+                packet.axis[lane] = axis;
+                packet.t[lane] = tExit;
+            }
+
+            // Lanes that stepped out of the grid missed
+            for (uint32_t remaining = active; remaining; remaining &= remaining - 1)
+            {
+                const int lane = std::countr_zero(remaining);
+                const int axis = packet.axis[lane];
+                if (packet.cell[axis][lane] < 0 || packet.cell[axis][lane] >= size[axis]) active &= ~(1u << lane);
+            }
+        }
+    }
+
+    bool VoxelObject::BeginTraversal(const Ray& ray, RayTraversal& traversal) const
+    {
+        // Work in grid space
+        Ray& r = traversal.ray;
+        r = Ray(ray.origin - glm::vec3(offset), ray.direction);
+        if (r.direction == glm::vec3(0.0f))
+        {
+            Error("Bad raycast (0 direction!)");
+            return false;
+        }
+
+        // Determine intersection with the grid
+        const glm::ivec3 size(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth());
+        const glm::vec2 tNearFar = r.Slabs(IAABB(glm::ivec3(0), size));
+        if (tNearFar.x >= tNearFar.y || tNearFar.y < 0.0f) return false;
+
+        // Starting cell, and the face it was entered through if the ray starts outside the grid
+        traversal.t = glm::max(tNearFar.x, 0.0f);
+        traversal.cell = glm::clamp(glm::ivec3(glm::floor(r.origin + r.direction * traversal.t)), glm::ivec3(0), size - 1);
+        traversal.normal = glm::ivec3(0);
+        if (tNearFar.x > 0.0f)
+        {
+            int axis = 0;
+            float tEntry = -INFINITY;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (r.direction[i] == 0.0f) continue;
+                const float tPlane = ((r.direction[i] > 0.0f ? 0.0f : size[i]) - r.origin[i]) / r.direction[i];
+                if (tPlane > tEntry)
+                {
+                    tEntry = tPlane;
+                    axis = i;
+                }
+            }
+            traversal.normal[axis] = r.direction[axis] > 0.0f ? -1 : 1;
+            traversal.cell[axis] = r.direction[axis] > 0.0f ? 0 : size[axis] - 1;
+        }
+
+        traversal.invDirection = 1.0f / r.direction;
+        return true;
+    }
+
+    bool VoxelObject::StepTraversal(RayTraversal& traversal, float maxDistance, RaycastHit& hit) const
+    {
+        const Ray& r = traversal.ray;
+        const glm::ivec3 size(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth());
+        glm::ivec3& cell = traversal.cell;
+        if (traversal.t > maxDistance) return false;
+
+        // Find the largest empty block containing the cell (or stop at a voxel)
+        int blockSize = 1;
+        if (voxelGrid.IsRegionEmpty(cell.x, cell.y, cell.z))
+        {
+            blockSize = BrickGrid3D<int>::REGION_SIZE;
+        }
+        else if (voxelGrid.IsBrickEmpty(cell.x, cell.y, cell.z))
+        {
+            blockSize = BrickGrid3D<int>::BRICK_SIZE;
+        }
+        else
+        {
+            const int index = voxelGrid.Get(cell.x, cell.y, cell.z);
+            if (index != voxelGrid.GetEmptyValue())
+            {
+                hit.voxel = voxels[index];
+                hit.normal = traversal.normal;
+                hit.distance = traversal.t;
+                hit.hit = true;
+                return false;
+            }
+        }
+
+        // Step to the face the ray leaves the block through
+        // Blocks at the far edges of the grid are cut short, so the ray never steps to a cell beyond it
+        const glm::ivec3 blockMin = cell & ~(blockSize - 1);
+        const glm::ivec3 blockMax = glm::min(blockMin + blockSize, size);
+        int axis = 0;
+        float tExit = INFINITY;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (r.direction[i] == 0.0f) continue;
+            const float tPlane = ((r.direction[i] > 0.0f ? blockMax[i] : blockMin[i]) - r.origin[i]) * traversal.invDirection[i];
+            if (tPlane < tExit)
+            {
+                tExit = tPlane;
+                axis = i;
+            }
+        }
+
+        // The exit axis moves exactly one cell past the block, the others stay within it
+        const glm::vec3 exit = r.origin + r.direction * tExit;
+        for (int i = 0; i < 3; ++i)
+        {
+            cell[i] = glm::clamp((int)glm::floor(exit[i]), blockMin[i], blockMax[i] - 1);
+        }
+        cell[axis] = r.direction[axis] > 0.0f ? blockMax[axis] : blockMin[axis] - 1;
+        if (cell[axis] < 0 || cell[axis] >= size[axis]) return false;
+
+        traversal.normal = glm::ivec3(0);
+        traversal.normal[axis] = r.direction[axis] > 0.0f ? -1 : 1;
+        traversal.t = tExit;
+        return true;
+    }
+
+    template <typename AppearanceFunc>
+    uint8_t VoxelObject::GetVisibleFaces(int index, const std::vector<uint8_t>& transparent, AppearanceFunc appearanceOf) const
+    {
+        const Voxel& voxel = voxels[index];
+        const int16_t appearance = appearanceOf(index);
+        const glm::ivec3 cell = glm::ivec3(voxel.x, voxel.y, voxel.z) - offset;
+
+        uint8_t faces = 0;
+        for (int face = 0; face < 6; ++face)
+        {
+            const glm::ivec3 neighbourCell = cell + FACE_NORMALS[face];
+            const int neighbour = InGrid(neighbourCell) ? voxelGrid.Get(neighbourCell.x, neighbourCell.y, neighbourCell.z) : voxelGrid.GetEmptyValue();
+            if (neighbour == voxelGrid.GetEmptyValue())
+            {
+                faces |= 1 << face;
+                continue;
+            }
+
+            // Faces between voxels of the same appearance are hidden, other faces only by opaque voxels
+            // Burning voxels are always opaque
+            const int16_t other = appearanceOf(neighbour);
+            if (other != appearance && other != -1 && transparent[other]) faces |= 1 << face;
+        }
+
+        return faces;
+    }
+
     void VoxelObject::UpdateMesh()
     {
+        // Objects without a node (headless simulation) have no mesh
+        if (!GetNode()) return;
+
         // Create the mesh if it doesn't already exist
         if (!mesh)
         {
@@ -393,28 +1631,232 @@ namespace Phi
             {
                 mesh = &GetNode()->AddComponent<VoxelMesh>();
             }
+            meshDirty = true;
+        }
+
+        // Grab material lists
+        const Scene& scene = GetNode()->GetScene();
+        const auto& materials = GetMaterials();
+
+        // Faces behind transparent materials stay visible
+        std::vector<uint8_t> transparent;
+        for (const PBRMaterial& material : scene.GetPBRMaterials()) transparent.push_back(material.color.a < 1.0f);
+
+        // Patching re-evaluates each changed cell (and its face neighbours when culling),
+        // so past a point a rebuild is cheaper. Merged quads can not be patched
+        const size_t patchCost = meshChanges.size() * (meshMode == MeshMode::AllVoxels ? 1 : 7);
+        if (meshDirty || meshMode == MeshMode::Greedy || patchCost > voxels.size())
+        {
+            RebuildMesh(materials, transparent);
+        }
+        else
+        {
+            const int neighbourCount = meshMode == MeshMode::AllVoxels ? 0 : 6;
+            for (const glm::ivec3& changed : meshChanges)
+            {
+                for (int n = -1; n < neighbourCount; ++n)
+                {
+                    const glm::ivec3 cell = n == -1 ? changed : changed + FACE_NORMALS[n];
+                    if (!InGrid(cell)) continue;
+                    const int index = voxelGrid.Get(cell.x, cell.y, cell.z);
+                    if (index != voxelGrid.GetEmptyValue()) PatchMeshSlot(index, materials, transparent);
+                }
+            }
         }
 
-        // Grab material list
-        const auto& materials = GetNode()->GetScene().GetVoxelMaterials();
+        // Reset flags
+        meshChanges.clear();
+        meshDirty = false;
+    }
 
-        // Grab vertex list reference and clear old verts
+    void VoxelObject::RebuildMesh(const VoxelMaterialTable& materials, const std::vector<uint8_t>& transparent)
+    {
+        // Grab vertex and quad list references and clear old data
         auto& verts = mesh->Vertices();
+        auto& quads = mesh->Quads();
         verts.clear();
+        quads.clear();
+        meshSlots.assign(voxels.size(), -1);
+        slotVoxels.clear();
 
-        // Iterate all voxels
-        for (const Voxel& voxel : voxels)
+        // Mesh material of each voxel, gathered up front since each voxel is read by all of its neighbours
+        std::vector<int16_t> appearance(voxels.size());
+        for (size_t i = 0; i < voxels.size(); ++i)
         {
-            // Add the voxel to the new mesh
-            VoxelMesh::Vertex vert;
-            vert.x = voxel.x;
-            vert.y = voxel.y;
-            vert.z = voxel.z;
-            vert.material = (voxel.flags & Voxel::Flags::OnFire) ? -1 : materials[voxel.material].pbrID;
-            verts.push_back(vert);
+            appearance[i] = GetAppearance(voxels[i], materials);
+        }
+        auto appearanceOf = [&](int index) { return appearance[index]; };
+
+        if (meshMode == MeshMode::Greedy)
+        {
+            std::vector<uint8_t> visibleFaces(voxels.size());
+            for (size_t i = 0; i < voxels.size(); ++i)
+            {
+                visibleFaces[i] = GetVisibleFaces(i, transparent, appearanceOf);
+            }
+            MeshGreedy(visibleFaces, appearance, quads);
+        }
+        else
+        {
+            // Add every voxel (only those with a visible face when culling)
+            for (size_t i = 0; i < voxels.size(); ++i)
+            {
+                if (meshMode == MeshMode::CulledVoxels && !GetVisibleFaces(i, transparent, appearanceOf)) continue;
+                const Voxel& voxel = voxels[i];
+                meshSlots[i] = verts.size();
+                slotVoxels.push_back(i);
+                verts.push_back({voxel.x, voxel.y, voxel.z, appearance[i]});
+            }
+        }
+
+        mesh->MarkAllDirty();
+    }
+
+    void VoxelObject::PatchMeshSlot(int index, const VoxelMaterialTable& materials, const std::vector<uint8_t>& transparent)
+    {
+        // Hidden voxels have no vertex
+        auto appearanceOf = [&](int index) { return GetAppearance(voxels[index], materials); };
+        if (meshMode == MeshMode::CulledVoxels && !GetVisibleFaces(index, transparent, appearanceOf))
+        {
+            if (meshSlots[index] != -1) RemoveMeshSlot(index);
+            return;
+        }
+
+        // Add or update the vertex
+        auto& verts = mesh->Vertices();
+        const Voxel& voxel = voxels[index];
+        const VoxelMesh::Vertex vertex{voxel.x, voxel.y, voxel.z, GetAppearance(voxel, materials)};
+        int& slot = meshSlots[index];
+        if (slot == -1)
+        {
+            slot = verts.size();
+            slotVoxels.push_back(index);
+            verts.push_back(vertex);
+            mesh->MarkDirty(slot);
+        }
+        else if (!(verts[slot] == vertex))
+        {
+            verts[slot] = vertex;
+            mesh->MarkDirty(slot);
+        }
+    }
+
+    void VoxelObject::RemoveMeshSlot(int index)
+    {
+        // Swap and pop, patching the slot of the voxel whose vertex moved
+        auto& verts = mesh->Vertices();
+        const int slot = meshSlots[index];
+        const int last = verts.size() - 1;
+        if (slot != last)
+        {
+            verts[slot] = verts[last];
+            slotVoxels[slot] = slotVoxels[last];
+            meshSlots[slotVoxels[slot]] = slot;
+            mesh->MarkDirty(slot);
+        }
+        verts.pop_back();
+        slotVoxels.pop_back();
+        meshSlots[index] = -1;
+    }
+
+    void VoxelObject::MeshGreedy(const std::vector<uint8_t>& visibleFaces, const std::vector<int16_t>& appearance, std::vector<VoxelMesh::Quad>& quads) const
+    {
+        // Gather the visible faces in each direction
+        std::vector<MeshFace> faces[6];
+        for (size_t i = 0; i < voxels.size(); ++i)
+        {
+            if (!visibleFaces[i]) continue;
+            const glm::ivec3 cell = glm::ivec3(voxels[i].x, voxels[i].y, voxels[i].z) - offset;
+            for (int face = 0; face < 6; ++face)
+            {
+                if (!(visibleFaces[i] & (1 << face))) continue;
+                const int axis = face >> 1;
+                const uint64_t key = (uint64_t)cell[axis] << 32 | (uint64_t)cell[(axis + 2) % 3] << 16 | (uint64_t)cell[(axis + 1) % 3];
+                faces[face].push_back({key, appearance[i]});
+            }
+        }
+
+        // Faces of the current slice over the whole grid, in row-major order
+        // NOTE: The grid bounds are used rather than the AABB, since simulation can move voxels outside of it
+        static const int16_t NO_FACE = INT16_MIN;
+        std::vector<int16_t> slice;
+        std::vector<MeshFace> scratch;
+
+        const glm::ivec3 size(voxelGrid.GetWidth(), voxelGrid.GetHeight(), voxelGrid.GetDepth());
+        for (int face = 0; face < 6; ++face)
+        {
+            // Face axis and tangent axes (see VoxelMesh::Quad)
+            const int axis = face >> 1;
+            const int u = (axis + 1) % 3;
+            const int v = (axis + 2) % 3;
+            const int width = size[u];
+            const int height = size[v];
+
+            // Sort faces by slice, then row, then column
+            std::vector<MeshFace>& sorted = faces[face];
+            SortFaces(sorted, scratch, {width, height, size[axis]});
+            slice.assign((size_t)width * height, NO_FACE);
+
+            size_t first = 0;
+            while (first < sorted.size())
+            {
+                // Write the faces of this slice to the 2D grid
+                const int sliceIndex = sorted[first].key >> 32;
+                size_t last = first;
+                for (; last < sorted.size() && (int)(sorted[last].key >> 32) == sliceIndex; ++last)
+                {
+                    const MeshFace& f = sorted[last];
+                    slice[((f.key >> 16) & 0xffff) * width + (f.key & 0xffff)] = f.material;
+                }
+
+                // Each face not yet covered starts a quad, grown first along the row and then across rows
+                for (size_t i = first; i < last; ++i)
+                {
+                    const int fu = sorted[i].key & 0xffff;
+                    const int fv = (sorted[i].key >> 16) & 0xffff;
+                    int16_t* row = slice.data() + (size_t)fv * width;
+                    const int16_t material = row[fu];
+                    if (material == NO_FACE) continue;
+
+                    // Burning faces are never merged, so the fire effect still varies per voxel
+                    int quadWidth = 1;
+                    int quadHeight = 1;
+                    if (material != -1)
+                    {
+                        while (fu + quadWidth < width && row[fu + quadWidth] == material) quadWidth++;
+                        while (fv + quadHeight < height)
+                        {
+                            const int16_t* next = row + (size_t)quadHeight * width + fu;
+                            if (!std::all_of(next, next + quadWidth, [=](int16_t m) { return m == material; })) break;
+                            quadHeight++;
+                        }
+                    }
+
+                    // Mark the covered faces as used
+                    for (int y = 0; y < quadHeight; ++y)
+                    {
+                        std::fill_n(row + (size_t)y * width + fu, quadWidth, NO_FACE);
+                    }
+
+                    // Add the quad
+                    glm::ivec3 position = offset;
+                    position[axis] += sliceIndex;
+                    position[u] += fu;
+                    position[v] += fv;
+
+                    VoxelMesh::Quad quad;
+                    quad.x = position.x;
+                    quad.y = position.y;
+                    quad.z = position.z;
+                    quad.material = material;
+                    quad.width = quadWidth;
+                    quad.height = quadHeight;
+                    quad.face = face;
+                    quads.push_back(quad);
+                }
+
+                first = last;
+            }
         }
-        
-        // Reset flag
-        meshDirty = false;
     }
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #pragma once
 
-#include <phi/core/math/rng.hpp>
+#include <algorithm>
+#include <span>
+
+#include <phi/core/math/counter_rng.hpp>
 #include <phi/core/math/shapes.hpp>
-#include <phi/core/structures/grid_3d.hpp>
+#include <phi/core/structures/bit_grid_3d.hpp>
+#include <phi/core/structures/brick_grid_3d.hpp>
 #include <phi/scene/components/base_component.hpp>
 #include <phi/scene/components/renderable/voxel_mesh.hpp>
+#include <phi/scene/components/simulation/voxel_material.hpp>
+#include <phi/scene/components/simulation/voxel_object_format.hpp>
 
 namespace Phi
 {
@@ -58,6 +64,10 @@ namespace Phi
             VoxelObject &operator=(VoxelObject &&other) = delete;
 
             // Simulation flags for how the object will be updated
+            // SimulateFluids moves every liquid, powder, and gas voxel, SimulateFire spreads and burns out fire,
+            // and SimulateReactions applies material reactions with neighbouring voxels
+            // KeepSorted keeps the voxel array in Morton order, so voxels that are close in space are close in memory
+            // SplitIslands detaches groups of static voxels that lose their connection to the object (see DetachIslands())
             struct Flags
             {
                 Flags() = delete;
@@ -68,9 +78,38 @@ namespace Phi
                     SimulateFluids = 1,
                     SimulateFire = 1 << 1,
                     UpdateMesh = 1 << 2,
+                    SimulateReactions = 1 << 3,
+                    KeepSorted = 1 << 4,
+                    SplitIslands = 1 << 5,
                 };
             };
 
+            // Valid meshing modes
+            enum class MeshMode : int
+            {
+                // One cube per voxel
+                AllVoxels = 0,
+
+                // One cube per voxel with at least one visible face
+                CulledVoxels,
+
+                // Visible faces merged into quads per face direction and material
+                // Produces the fewest vertices, but takes the longest to build
+                Greedy
+            };
+
+            // A single voxel change, applied in batches by ApplyEdits()
+            struct Edit
+            {
+                // Position in object local space
+                int16_t x = 0;
+                int16_t y = 0;
+                int16_t z = 0;
+
+                // New voxel material index, or -1 to remove the voxel
+                int16_t material = -1;
+            };
+
             // Structure for returning ray cast query data
             struct RaycastInfo
             {
@@ -82,17 +121,85 @@ namespace Phi
                 int firstHit = -1;
             };
 
+            // Structure for returning hit-only ray cast query data
+            struct RaycastHit
+            {
+                // Copy of the first voxel hit
+                Voxel voxel;
+
+                // Normal of the voxel face the ray entered through (zero if the ray starts inside the voxel)
+                glm::ivec3 normal{0};
+
+                // Distance along the ray to the entry point, in multiples of the ray direction
+                float distance = 0.0f;
+
+                // True if a voxel was hit
+                bool hit = false;
+            };
+
+            // Scheduling statistics, maintained by VoxelScheduler
+            struct SimulationStats
+            {
+                // Moving average of the time taken by a single tick, in milliseconds
+                float tickCost = 0.0f;
+
+                // Simulation time owed to the object, in seconds
+                float lag = 0.0f;
+
+                // Tick rate the object is currently scheduled at, in ticks per second
+                float tickRate = 0.0f;
+
+                // Ticks run during the last frame
+                int ticks = 0;
+
+                // Total ticks skipped because the object fell too far behind
+                uint64_t droppedTicks = 0;
+
+                // Scheduler frame the object last ticked on, objects waiting longest go first among equals
+                uint64_t lastTickFrame = 0;
+            };
+
             // Simulation
 
-            // Updates the object according to the simulation flags set
+            // Updates the object according to the simulation flags set, at most one tick per call
+            // Each simulation tick reads from the current voxel state and writes to a back buffer,
+            // so results are independent of voxel order (see Step())
+            // NOTE: Objects in a scene are ticked by the scene's VoxelScheduler instead
             void Update(float delta);
 
+            // Sets the full simulation rate of the object, in ticks per second
+            // Schedulers may tick the object less often (e.g. when it is far from the camera)
+            inline void SetTickRate(int rate) { updatesPerSecond = std::max(rate, 1); updateRate = 1.0f / updatesPerSecond; }
+
+            // Returns the full simulation rate of the object, in ticks per second
+            inline int GetTickRate() const { return updatesPerSecond; }
+
+            // Returns the scheduling statistics of the object
+            inline const SimulationStats& GetSimulationStats() const { return simulationStats; }
+
             // Sets the given simulation flags
-            inline void Enable(Flags::type flags) { this->flags |= flags; }
+            inline void Enable(Flags::type flags) { this->flags |= flags; WakeAll(); }
 
             // Unsets the given simulation flags
             inline void Disable(Flags::type flags) { this->flags &= !flags; }
 
+            // Sets the maximum number of threads used to simulate this object, including the calling thread
+            // 0 uses every worker in the shared thread pool, 1 simulates serially on the calling thread
+            // NOTE: Results are identical for any thread count
+            inline void SetThreadCount(int count) { threadCount = count; }
+
+            // Sets the material table used for simulation and loading, instead of the scene's (NON-OWNING)
+            // Lets objects that were never added to a node be simulated without a scene (meshing is skipped)
+            // Pass nullptr to use the scene's table again
+            inline void SetMaterialTable(const VoxelMaterialTable* table) { materialTable = table; }
+
+            // Sets the seed of the simulation's random numbers
+            // NOTE: Results depend only on the seed and the voxel state, never on update order or thread count
+            inline void SetSeed(uint32_t seed) { simulationRNG.SetSeed(seed); }
+
+            // Returns the number of voxels that will be simulated next tick
+            inline size_t GetActiveCount() const { return activeVoxels.size(); }
+
             // Voxel data management
 
             // Gets a pointer to the voxel at the object local coordinates provided,
@@ -100,56 +207,87 @@ namespace Phi
             // NOTE: Does not validate position
             inline const Voxel* GetVoxel(int16_t x, int16_t y, int16_t z)
             {
-                int index = voxelGrid(x - offset.x, y - offset.y, z - offset.z);
+                int index = voxelGrid.Get(x - offset.x, y - offset.y, z - offset.z);
                 return index == -1 ? nullptr : &voxels[index];
             }
 
+            // Returns true if the object local position lies within the voxel grid
+            inline bool IsInGrid(const glm::ivec3& position) const { return InGrid(position - offset); }
+
+            // Returns every voxel in the object
+            // NOTE: Order is not stable across edits or simulation ticks (even when kept sorted)
+            inline std::span<const Voxel> GetVoxels() const { return voxels; }
+
             // Sets the voxel data to a specific material
             // NOTE: Does not validate position
-            inline void SetVoxel(int16_t x, int16_t y, int16_t z, int16_t material)
-            {
-                // Initialize voxel data
-                Voxel voxel;
-                voxel.x = x;
-                voxel.y = y;
-                voxel.z = z;
-                voxel.material = material;
-
-                // Place on grid (update existing or push back)
-                int& index = voxelGrid(x - offset.x, y - offset.y, z - offset.z);
-                if (index == -1)
-                {
-                    index = voxels.size();
-                    voxels.push_back(voxel);
-                }
-                else
-                {
-                    voxels[index] = voxel;
-                }
+            void SetVoxel(int16_t x, int16_t y, int16_t z, int16_t material);
 
-                // Set flag
-                meshDirty = true;
-            }
+            // Removes the voxel at the object local coordinates provided, if one exists
+            // The last voxel in the internal array takes its place, so removal is O(1)
+            // but indices of other voxels are not stable
+            // Returns true if a voxel was removed
+            // NOTE: Does not validate position
+            bool RemoveVoxel(int16_t x, int16_t y, int16_t z);
 
-            // TODO: Remove voxels without rebuilding all indices...
+            // Applies a list of sets and removes in order
+            // The mesh is flagged dirty and the AABB is updated once for the whole list
+            // NOTE: Does not validate positions
+            void ApplyEdits(std::span<const Edit> edits);
 
             // Loads voxel data from a .vobj file, replacing any existing data
+            // Text and binary files are detected automatically (see VoxelObjectFormat)
             // Accepts local paths like data:// and user://
             bool Load(const std::string &path);
 
             // Resets and unloads all voxel data, including mesh vertices
             void Reset();
 
+            // Fragmentation
+            // Static voxels (materials without movement rules) are connected through shared faces
+            // With SplitIslands set, cells where static voxels are removed or start moving are recorded as damage
+
+            // Finds groups of static voxels cut off from the rest of the object by damage since the last call,
+            // and moves each into a new VoxelObject node with the same transform, parent, flags, and materials
+            // Only cells within ISLAND_SEARCH_MARGIN of the damage are searched, so the cost scales with the damaged area
+            // NOTE: Groups reaching past the searched region are assumed to still be connected
+            // Returns the number of islands detached (always 0 for objects without a node)
+            int DetachIslands();
+
+            // Number of cells searched around damage along each axis by DetachIslands()
+            static const int ISLAND_SEARCH_MARGIN = 32;
+
             // Spatial queries
 
             // Casts an object-local ray into the voxel object, returns voxel intersection information
+            // Every cell visited is recorded, use RaycastFirst() when only the hit is needed
             RaycastInfo Raycast(const Ray &ray, int maxSteps = 512);
 
+            // Casts an object-local ray into the voxel object, returns the first voxel hit within maxDistance
+            // Empty bricks and regions of the voxel grid are crossed in a single step, and nothing is allocated
+            RaycastHit RaycastFirst(const Ray &ray, float maxDistance = 512.0f) const;
+
+            // Casts a batch of object-local rays into the voxel object, writing the result of rays[i] to hits[i]
+            // Rays are traced in packets of RAYS_PER_PACKET, and large batches are split across the shared thread pool
+            // NOTE: Results are identical to calling RaycastFirst() for each ray
+            void RaycastBatch(std::span<const Ray> rays, std::span<RaycastHit> hits, float maxDistance = 512.0f) const;
+
+            // Number of rays traced together by RaycastBatch()
+            static constexpr int RAYS_PER_PACKET = 8;
+
             // Mesh management
 
             // Updates the internal mesh to match the voxel grid
+            // A voxel face is visible unless the neighbouring voxel is opaque or has the same appearance
+            // Only voxels near cells changed since the last update are re-meshed, and their vertices patched in place.
+            // The whole mesh is rebuilt when first created, after loading, in greedy mode, or after very many changes
             void UpdateMesh();
 
+            // Sets the meshing mode used by UpdateMesh()
+            inline void SetMeshMode(MeshMode mode) { meshMode = mode; meshDirty = true; }
+
+            // Returns the meshing mode used by UpdateMesh()
+            inline MeshMode GetMeshMode() const { return meshMode; }
+
             // Returns a pointer to the internal mesh component,
             // or nullptr if none exists
             inline VoxelMesh *GetMesh() const { return mesh; }
@@ -163,19 +301,103 @@ namespace Phi
             // Spatial index for voxels
             // -1 indicates an empty spot on the grid
             // Any other non-negative value indicates an index into the internal voxel array
-            Grid3D<int> voxelGrid;
+            // Stored sparsely, so memory scales with occupied volume rather than the bounds of the object
+            BrickGrid3D<int> voxelGrid;
 
             // Array of all voxel data
             std::vector<Voxel> voxels;
 
+            // Bit masks mirroring voxelGrid, used for neighbour queries during simulation
+            // Kept up to date whenever a voxel is set, moved, or changes state
+            // Movement masks hold a bit for each voxel whose material has the corresponding movement rule
+            // Reaction masks hold voxels that may transform: burning voxels with a burn product (decaying),
+            // and voxels whose material has actions with neighbouring materials (reactive)
+            BitGrid3D occupancyMask;
+            BitGrid3D fallMask;
+            BitGrid3D riseMask;
+            BitGrid3D slideMask;
+            BitGrid3D spreadMask;
+            BitGrid3D diffuseMask;
+            BitGrid3D flammableMask;
+            BitGrid3D burningMask;
+            BitGrid3D decayingMask;
+            BitGrid3D reactiveMask;
+
             // Offset to apply to obtain object-local space coordinates
             glm::ivec3 offset;
 
+            // Simulation write buffer, swapped with voxels at the end of each tick
+            std::vector<Voxel> backVoxels;
+
+            // Grid space cells damaged since the last island search (see DetachIslands())
+            std::vector<glm::ivec3> damagedCells;
+
+            // Spatial ordering (see SortVoxels())
+            // Number of voxels added or moved since the last sort, and scratch space for sorting
+            size_t unsortedCount = 0;
+            std::vector<uint64_t> sortKeys;
+            std::vector<int> sortOrder;
+            std::vector<int> sortRun;
+            std::vector<int> sortDisplaced;
+
+            // With KeepSorted set, the voxel array is sorted again once more than 1 / RESORT_DIVISOR of it has been displaced
+            static const int RESORT_DIVISOR = 16;
+
+            // A pending change to a single grid cell, applied after every block has been simulated
+            struct CellWrite
+            {
+                glm::ivec3 cell;
+                int index;
+            };
+
+            // Output of a single simulation job
+            // Each job owns its output lists, so jobs never share writable state
+            struct SimulationJob
+            {
+                // Grid cells changed by the job
+                std::vector<CellWrite> cellWrites;
+
+                // Voxels whose back buffer state differs from the current state
+                std::vector<int> changedVoxels;
+
+                // Voxels that did not change, but may change next tick
+                std::vector<int> awakeVoxels;
+            };
+
+            // Simulation jobs
+            // Each job simulates a run of BLOCKS_PER_JOB active blocks
+            static const int BLOCKS_PER_JOB = 512;
+            std::vector<SimulationJob> jobs;
+
+            // Active set
+            // Only voxels that may change (burning neighbours or free space to flow into) are simulated,
+            // and only voxels near a change since the last tick are re-evaluated
+            std::vector<int> activeVoxels;
+            std::vector<uint8_t> activeFlags;
+            std::vector<int> activeBlocks;
+
+            // Maximum number of threads used for simulation (0 = no limit)
+            int threadCount = 0;
+
             // Timing
             int updatesPerSecond = 60;
             float timeAccum = 0.0f;
             float updateRate = 1.0f / updatesPerSecond;
 
+            // Number of simulation ticks performed, used to alternate block partitions
+            // and to key the simulation's random numbers
+            uint32_t tick = 0;
+
+            // Material table override (NON-OWNING)
+            const VoxelMaterialTable* materialTable = nullptr;
+
+            // Scheduling statistics (see VoxelScheduler)
+            SimulationStats simulationStats;
+
+            // Simulation random numbers, keyed by (grid cell, tick, salt)
+            // Keying on the cell instead of drawing from a shared sequence keeps results independent of block order
+            CounterRNG simulationRNG;
+
             // Simulation flags
             Flags::type flags;
 
@@ -184,6 +406,186 @@ namespace Phi
 
             // Internal mesh component (NON-OWNING)
             VoxelMesh *mesh = nullptr;
+            MeshMode meshMode = MeshMode::CulledVoxels;
+
+            // True if the whole mesh must be rebuilt
             bool meshDirty = true;
+
+            // Grid cells changed since the last mesh update
+            std::vector<glm::ivec3> meshChanges;
+
+            // Index of each voxel's mesh vertex (or -1 if it has none), and the voxel index of each mesh vertex
+            std::vector<int> meshSlots;
+            std::vector<int> slotVoxels;
+
+            // State of a single ray walking the voxel grid, see RaycastFirst()
+            struct RayTraversal
+            {
+                // Ray in grid space
+                Ray ray;
+                glm::vec3 invDirection;
+
+                // Current cell, the face it was entered through, and the distance along the ray to the entry point
+                glm::ivec3 cell;
+                glm::ivec3 normal;
+                float t;
+            };
+
+            // State of a packet of RAYS_PER_PACKET rays walking the voxel grid together, see RaycastBatch()
+            // Stored as arrays per component, so the geometry of each step is computed for every lane in one loop
+            struct RayPacket
+            {
+                // Rays in grid space, and a mask per axis that is all ones where the direction is positive
+                float origin[3][RAYS_PER_PACKET];
+                float direction[3][RAYS_PER_PACKET];
+                float invDirection[3][RAYS_PER_PACKET];
+                int positive[3][RAYS_PER_PACKET];
+
+                // Current cell, the size of the empty block containing it, the axis of the face it was entered through
+                // (or -1 if the ray started in it), and the distance along the ray to the entry point
+                int cell[3][RAYS_PER_PACKET];
+                int blockSize[RAYS_PER_PACKET];
+                int axis[RAYS_PER_PACKET];
+                float t[RAYS_PER_PACKET];
+            };
+
+            // Number of packets traced by each RaycastBatch() job
+            static const int PACKETS_PER_JOB = 128;
+
+            // Internal helper functions
+
+            // Returns the material table override if set, or the scene's table otherwise
+            const VoxelMaterialTable& GetMaterials() const;
+
+            // Starts a grid space traversal of the given object-local ray
+            // Returns false if the ray misses the grid entirely
+            bool BeginTraversal(const Ray& ray, RayTraversal& traversal) const;
+
+            // Advances a traversal past the empty cell, brick, or region it is in
+            // Writes to hit and returns false once a voxel is hit or the ray leaves the grid or exceeds maxDistance
+            bool StepTraversal(RayTraversal& traversal, float maxDistance, RaycastHit& hit) const;
+
+            // Traces up to RAYS_PER_PACKET rays together, writing the result of rays[i] to hits[i]
+            // Matches StepTraversal() exactly, but lanes step in lockstep and the exit geometry is computed across lanes
+            void TracePacket(std::span<const Ray> rays, std::span<RaycastHit> hits, float maxDistance) const;
+
+            // Returns true if any simulation flag is set
+            inline bool IsSimulated() const
+            {
+                return flags & (Flags::SimulateFluids | Flags::SimulateFire | Flags::SimulateReactions);
+            }
+
+            // Updates the mesh if the UpdateMesh flag is set and any voxel changed since the last update
+            inline void RefreshMesh()
+            {
+                if ((flags & Flags::UpdateMesh) && (meshDirty || meshChanges.size() > 0)) UpdateMesh();
+            }
+
+            // Finds the islands cut off by damagedCells, as lists of grid space cells (see DetachIslands())
+            // Static voxels in the searched region are split into runs along X, which are joined by a union-find
+            // in parallel slabs along Z, then across slab boundaries
+            void FindIslands(std::vector<std::vector<glm::ivec3>>& islands) const;
+
+            // Returns true if voxels of the given material never move
+            inline bool IsStatic(int16_t material, const VoxelMaterialTable& materials) const
+            {
+                return materials.movement[material] == VoxelMaterialTable::Move::None;
+            }
+
+            // Performs a single simulation tick
+            // The grid is partitioned into 2x2x2 blocks (Margolus neighbourhood), offset by one cell on odd ticks.
+            // Voxels may only move within their block, so blocks never write to the same cell,
+            // and all neighbour reads come from the previous tick's state
+            void Step();
+
+            // Simulates the block with the given grid space origin
+            // Writes voxel state to backVoxels and records the outcome in job
+            void SimulateBlock(const glm::ivec3& origin, const VoxelMaterialTable& materials, SimulationJob& job);
+
+            // Places a voxel of the given material at the given grid space cell, without updating the AABB or mesh
+            void PlaceVoxel(const glm::ivec3& cell, int16_t material, const VoxelMaterialTable& materials);
+
+            // Removes the voxel at the given grid space cell, without updating the AABB or mesh
+            // Returns true if a voxel was removed
+            bool EraseVoxel(const glm::ivec3& cell, const VoxelMaterialTable& materials);
+
+            // Replaces all voxel data with the given records
+            // materialNames translates record material indices to scene material IDs
+            void LoadRecords(const std::vector<std::string>& materialNames, std::span<const VoxelObjectFormat::Record> records,
+                             const glm::ivec3& min, const glm::ivec3& max);
+
+            // Records a change to the given grid space cell for the next mesh update
+            inline void MarkMeshChange(const glm::ivec3& cell)
+            {
+                if (!meshDirty) meshChanges.push_back(cell);
+            }
+
+            // Rebuilds the whole mesh
+            // transparent holds a flag for each PBR material that does not hide the faces behind it
+            void RebuildMesh(const VoxelMaterialTable& materials, const std::vector<uint8_t>& transparent);
+
+            // Adds, updates, or removes the mesh vertex of the voxel with the given index to match its current state
+            void PatchMeshSlot(int index, const VoxelMaterialTable& materials, const std::vector<uint8_t>& transparent);
+
+            // Removes the mesh vertex of the voxel with the given index, the last vertex takes its place
+            void RemoveMeshSlot(int index);
+
+            // Returns a bit for each visible face of the voxel with the given index, ordered as in VoxelMesh::Quad
+            // appearanceOf(index) returns the mesh material of the voxel with the given index
+            template <typename AppearanceFunc>
+            uint8_t GetVisibleFaces(int index, const std::vector<uint8_t>& transparent, AppearanceFunc appearanceOf) const;
+
+            // Returns the mesh material of the given voxel (its PBR material ID, or -1 for the fire effect)
+            inline int16_t GetAppearance(const Voxel& voxel, const VoxelMaterialTable& materials) const
+            {
+                return (voxel.flags & Voxel::Flags::OnFire) ? -1 : materials.pbrID[voxel.material];
+            }
+
+            // Appends greedily merged quads for every visible face to quads
+            // visibleFaces holds a bit per face direction for each voxel, appearance holds each voxel's mesh material
+            void MeshGreedy(const std::vector<uint8_t>& visibleFaces, const std::vector<int16_t>& appearance, std::vector<VoxelMesh::Quad>& quads) const;
+
+            // Recalculates the AABB from every voxel
+            void RecalculateAABB();
+
+            // Sorts the voxel array into Morton (Z-order) order of grid cells, and remaps every index into it
+            // Voxels still in order are kept as a single run, and only the voxels displaced from it are sorted
+            // and merged back in, so re-sorting a mostly sorted array is close to linear
+            void SortVoxels();
+
+            // Sorts the voxel array if KeepSorted is set and enough voxels have been displaced since the last sort
+            inline void SortIfNeeded()
+            {
+                if ((flags & Flags::KeepSorted) && unsortedCount * RESORT_DIVISOR > voxels.size()) SortVoxels();
+            }
+
+            // Updates every mask at the given grid space cell to match voxel (or nullptr if the cell is empty)
+            void UpdateMasks(const glm::ivec3& cell, const Voxel* voxel, const VoxelMaterialTable& materials);
+
+            // Returns a bit for each voxel in the given word of the row (y, z) that may change next tick
+            // Evaluated over whole rows from the masks, so no voxel data is touched
+            uint64_t ActiveBits(int word, int y, int z) const;
+
+            // Adds the voxel with the given index to the active set
+            void Wake(int index);
+
+            // Wakes the voxel at the given grid space cell and each of its face neighbours that may change next tick
+            void WakeNeighbourhood(const glm::ivec3& cell);
+
+            // Adds every voxel that may change next tick to the active set
+            void WakeAll();
+
+            // Returns true if the given grid space cell is within the bounds of the grid
+            inline bool InGrid(const glm::ivec3& cell) const
+            {
+                return cell.x >= 0 && cell.y >= 0 && cell.z >= 0 &&
+                       cell.x < voxelGrid.GetWidth() && cell.y < voxelGrid.GetHeight() && cell.z < voxelGrid.GetDepth();
+            }
+
+        // Friends
+        private:
+
+            // Necessary for the scheduler to run ticks and track statistics
+            friend class VoxelScheduler;
     };
 }
\ No newline at end of file
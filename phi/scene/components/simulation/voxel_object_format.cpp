@@ -0,0 +1,307 @@
+#include "voxel_object_format.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include <phi/core/thread_pool.hpp>
+
+namespace Phi
+{
+    namespace VoxelObjectFormat
+    {
+        bool IsBinary(const uint8_t* data, size_t size)
+        {
+            return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+        }
+
+        bool IsValidBounds(const glm::ivec3& min, const glm::ivec3& max)
+        {
+            if (glm::any(glm::greaterThan(min, max))) return false;
+
+            const glm::ivec3 extent = max - min + 1;
+            if (glm::any(glm::greaterThan(extent, glm::ivec3(MAX_EXTENT)))) return false;
+            return (size_t)extent.x * extent.y * extent.z <= MAX_VOLUME;
+        }
+
+        const Header* ValidateBinary(const uint8_t* data, size_t size, std::string& error)
+        {
+            // Header
+            if (!IsBinary(data, size) || size < sizeof(Header))
+            {
+                error = "Missing binary header";
+                return nullptr;
+            }
+            const Header* header = reinterpret_cast<const Header*>(data);
+            if (header->version != VERSION)
+            {
+                error = "Unsupported version " + std::to_string(header->version);
+                return nullptr;
+            }
+
+            // Bounds, objects allocate them whole
+            const glm::ivec3 min(header->min[0], header->min[1], header->min[2]);
+            const glm::ivec3 max(header->max[0], header->max[1], header->max[2]);
+            if (!IsValidBounds(min, max))
+            {
+                error = "Invalid bounds (" + std::to_string(min.x) + ", " + std::to_string(min.y) + ", " + std::to_string(min.z) + ") to (" +
+                        std::to_string(max.x) + ", " + std::to_string(max.y) + ", " + std::to_string(max.z) + ")";
+                return nullptr;
+            }
+
+            // Material table
+            size_t offset = header->materialTableOffset;
+            for (uint32_t i = 0; i < header->materialCount; ++i)
+            {
+                uint16_t length;
+                if (offset + sizeof(length) > size)
+                {
+                    error = "Truncated material table";
+                    return nullptr;
+                }
+                std::memcpy(&length, data + offset, sizeof(length));
+                offset += sizeof(length) + length;
+            }
+            if (offset > size)
+            {
+                error = "Truncated material table";
+                return nullptr;
+            }
+
+            // Voxel records
+            if (header->voxelOffset % alignof(Record) != 0 || header->voxelOffset + (size_t)header->voxelCount * sizeof(Record) > size)
+            {
+                error = "Truncated or misaligned voxel records";
+                return nullptr;
+            }
+            const Record* records = GetRecords(data);
+            for (uint32_t i = 0; i < header->voxelCount; ++i)
+            {
+                const Record& record = records[i];
+                if (record.material >= header->materialCount ||
+                    record.x < header->min[0] || record.y < header->min[1] || record.z < header->min[2] ||
+                    record.x > header->max[0] || record.y > header->max[1] || record.z > header->max[2])
+                {
+                    error = "Invalid voxel record " + std::to_string(i);
+                    return nullptr;
+                }
+            }
+
+            return header;
+        }
+
+        std::vector<std::string> ReadMaterials(const uint8_t* data)
+        {
+            const Header* header = reinterpret_cast<const Header*>(data);
+            std::vector<std::string> materials;
+            materials.reserve(header->materialCount);
+
+            size_t offset = header->materialTableOffset;
+            for (uint32_t i = 0; i < header->materialCount; ++i)
+            {
+                uint16_t length;
+                std::memcpy(&length, data + offset, sizeof(length));
+                offset += sizeof(length);
+                materials.emplace_back(reinterpret_cast<const char*>(data + offset), length);
+                offset += length;
+            }
+
+            return materials;
+        }
+
+        // Returns the line starting at pos (without the line ending) and advances pos past it
+        static std::string_view NextLine(const char* data, size_t size, size_t& pos)
+        {
+            const char* start = data + pos;
+            const char* newline = (const char*)std::memchr(start, '\n', size - pos);
+            const char* end = newline ? newline : data + size;
+            pos = newline ? newline - data + 1 : size;
+
+            // Tolerate CRLF line endings
+            if (end > start && end[-1] == '\r') end--;
+            return std::string_view(start, end - start);
+        }
+
+        // Parses the next integer in [pos, end), skipping leading whitespace
+        static bool ParseInt(const char*& pos, const char* end, int& value)
+        {
+            while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+            const std::from_chars_result result = std::from_chars(pos, end, value);
+            if (result.ec != std::errc()) return false;
+            pos = result.ptr;
+            return true;
+        }
+
+        // Output of parsing a single slice of voxel lines
+        struct TextSlice
+        {
+            std::vector<Record> records;
+            glm::ivec3 min{0};
+            glm::ivec3 max{0};
+            bool valid = true;
+        };
+
+        // Parses every voxel line in [data, data + size)
+        static void ParseVoxels(const char* data, size_t size, bool zAxisVertical, int materialCount, TextSlice& slice)
+        {
+            // Roughly 12 bytes per line in typical files
+            slice.records.reserve(size / 12);
+
+            size_t pos = 0;
+            while (pos < size)
+            {
+                const std::string_view line = NextLine(data, size, pos);
+
+                // Ignore comments and empty lines
+                if (line.empty() || line[0] == '#') continue;
+
+                // Parse the voxel data
+                const char* cursor = line.data();
+                const char* end = line.data() + line.size();
+                int x, y, z, material;
+                const bool parsed = zAxisVertical
+                    ? ParseInt(cursor, end, x) && ParseInt(cursor, end, z) && ParseInt(cursor, end, y) && ParseInt(cursor, end, material)
+                    : ParseInt(cursor, end, x) && ParseInt(cursor, end, y) && ParseInt(cursor, end, z) && ParseInt(cursor, end, material);
+                if (!parsed || material < 0 || material >= materialCount)
+                {
+                    slice.valid = false;
+                    return;
+                }
+
+                // Update min and max coords
+                const glm::ivec3 position(x, y, z);
+                slice.min = glm::min(slice.min, position);
+                slice.max = glm::max(slice.max, position);
+
+                // Add to voxel data
+                slice.records.push_back({(int16_t)x, (int16_t)y, (int16_t)z, (uint16_t)material});
+            }
+        }
+
+        bool ParseText(const char* data, size_t size, Model& model)
+        {
+            size_t pos = 0;
+            int phase = 0;
+            bool zAxisVertical = false;
+            while (pos < size)
+            {
+                const size_t lineStart = pos;
+                const std::string_view line = NextLine(data, size, pos);
+
+                // Ignore comments and empty lines
+                if (line.empty() || line[0] == '#') continue;
+
+                // Setup phase
+                if (line == ".materials")
+                {
+                    phase = 1;
+                    continue;
+                }
+                if (line == ".voxels")
+                {
+                    phase = 2;
+                    continue;
+                }
+                if (line == ".z_axis_vertical") zAxisVertical = true;
+
+                // Material parsing
+                if (phase == 1)
+                {
+                    // Extract the name (materials are listed in index order)
+                    const size_t colon = line.find_first_of(':');
+                    model.materials.emplace_back(colon + 2 <= line.size() ? line.substr(colon + 2) : std::string_view());
+                }
+
+                // Voxel data parsing
+                // The section runs until the next directive line (or the end of the file)
+                if (phase == 2 && line[0] != '.')
+                {
+                    size_t sectionEnd = lineStart;
+                    while (sectionEnd < size)
+                    {
+                        const char* newline = (const char*)std::memchr(data + sectionEnd, '\n', size - sectionEnd);
+                        sectionEnd = newline ? newline - data + 1 : size;
+                        if (sectionEnd < size && data[sectionEnd] == '.') break;
+                    }
+                    const char* section = data + lineStart;
+                    const size_t sectionSize = sectionEnd - lineStart;
+
+                    // Split large sections into slices at line boundaries and parse them concurrently
+                    ThreadPool& threadPool = ThreadPool::Instance();
+                    const int sliceCount = std::clamp((int)(sectionSize / TEXT_SLICE_SIZE), 1, threadPool.GetWorkerCount() + 1);
+                    std::vector<TextSlice> slices(sliceCount);
+                    threadPool.ParallelFor(sliceCount, [&](int i)
+                    {
+                        auto boundary = [&](int c)
+                        {
+                            if (c <= 0) return (size_t)0;
+                            if (c >= sliceCount) return sectionSize;
+                            const size_t approx = sectionSize * c / sliceCount;
+                            const char* newline = (const char*)std::memchr(section + approx, '\n', sectionSize - approx);
+                            return newline ? (size_t)(newline - section + 1) : sectionSize;
+                        };
+                        const size_t first = boundary(i);
+                        const size_t last = boundary(i + 1);
+                        if (first < last) ParseVoxels(section + first, last - first, zAxisVertical, model.materials.size(), slices[i]);
+                    });
+
+                    // Merge slices in file order and reduce bounds
+                    size_t count = model.records.size();
+                    for (const TextSlice& slice : slices)
+                    {
+                        if (!slice.valid) return false;
+                        count += slice.records.size();
+                    }
+                    model.records.reserve(count);
+                    for (const TextSlice& slice : slices)
+                    {
+                        model.records.insert(model.records.end(), slice.records.begin(), slice.records.end());
+                        model.min = glm::min(model.min, slice.min);
+                        model.max = glm::max(model.max, slice.max);
+                    }
+
+                    pos = sectionEnd;
+                }
+            }
+
+            return IsValidBounds(model.min, model.max);
+        }
+
+        bool WriteBinary(std::ostream& stream, const Model& model)
+        {
+            // Material table follows the header directly
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            for (int i = 0; i < 3; ++i)
+            {
+                header.min[i] = model.min[i];
+                header.max[i] = model.max[i];
+            }
+            header.materialCount = model.materials.size();
+            header.materialTableOffset = sizeof(Header);
+
+            // Records follow the material table, aligned
+            size_t offset = header.materialTableOffset;
+            for (const std::string& name : model.materials) offset += sizeof(uint16_t) + name.size();
+            const size_t padding = (alignof(Record) - offset % alignof(Record)) % alignof(Record);
+            header.voxelCount = model.records.size();
+            header.voxelOffset = offset + padding;
+
+            // Write everything
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const std::string& name : model.materials)
+            {
+                const uint16_t length = name.size();
+                stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                stream.write(name.data(), length);
+            }
+            const char zeros[alignof(Record)] = {};
+            stream.write(zeros, padding);
+            stream.write(reinterpret_cast<const char*>(model.records.data()), model.records.size() * sizeof(Record));
+
+            return (bool)stream;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Phi
+{
+    // Voxel object file (.vobj) formats
+    // Two formats share the extension, and readers detect which one a file uses from its first bytes:
+    // 1. Text - A human readable list of materials and voxels, one per line
+    // 2. Binary - A header, a material name table, and packed voxel records that can be used in place
+    namespace VoxelObjectFormat
+    {
+        // Identifies binary files
+        inline constexpr char MAGIC[4] = {'P', 'V', 'O', 'X'};
+
+        // Current binary format version, increment on any layout change
+        inline constexpr uint16_t VERSION = 1;
+
+        // Largest voxel bounds a file may declare, objects allocate their whole bounds up front
+        inline constexpr int MAX_EXTENT = 1024;
+        inline constexpr size_t MAX_VOLUME = 128 * 1024 * 1024;
+
+        // Returns true if the inclusive bounds are ordered and within MAX_EXTENT and MAX_VOLUME
+        bool IsValidBounds(const glm::ivec3& min, const glm::ivec3& max);
+
+        // Binary file header, stored at the start of the file
+        // All values are little-endian
+        struct Header
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t flags;
+
+            // Inclusive voxel bounds in object local space
+            int16_t min[3];
+            int16_t max[3];
+
+            // Material name table: materialCount entries of (uint16_t length, char name[length])
+            uint32_t materialCount;
+            uint32_t materialTableOffset;
+
+            // Voxel records, aligned to alignof(Record)
+            uint32_t voxelCount;
+            uint32_t voxelOffset;
+        };
+        static_assert(sizeof(Header) == 36);
+
+        // A single packed voxel in object local space (Y up)
+        // Material indexes the file's material name table
+        struct Record
+        {
+            int16_t x;
+            int16_t y;
+            int16_t z;
+            uint16_t material;
+        };
+        static_assert(sizeof(Record) == 8);
+
+        // Voxel data read from a text file
+        struct Model
+        {
+            // Material names, indexed by Record::material
+            std::vector<std::string> materials;
+
+            // Voxels in file order
+            std::vector<Record> records;
+
+            // Inclusive voxel bounds (always contain the origin)
+            glm::ivec3 min{0};
+            glm::ivec3 max{0};
+        };
+
+        // Returns true if the given data begins with a binary header
+        bool IsBinary(const uint8_t* data, size_t size);
+
+        // Returns a pointer to the header of binary data after validating the header, material table, and records,
+        // or nullptr (with an error message in error) if the data is not a valid binary file
+        const Header* ValidateBinary(const uint8_t* data, size_t size, std::string& error);
+
+        // Reads the material names from validated binary data
+        std::vector<std::string> ReadMaterials(const uint8_t* data);
+
+        // Returns a pointer to the voxel records in validated binary data
+        inline const Record* GetRecords(const uint8_t* data)
+        {
+            return reinterpret_cast<const Record*>(data + reinterpret_cast<const Header*>(data)->voxelOffset);
+        }
+
+        // Minimum size of a slice of voxel lines parsed by a single thread
+        inline constexpr size_t TEXT_SLICE_SIZE = 64 * 1024;
+
+        // Parses text file contents into model, returns false on failure (including bounds that fail IsValidBounds())
+        // Large voxel sections are split into slices of whole lines and parsed on the shared thread pool
+        bool ParseText(const char* data, size_t size, Model& model);
+
+        // Writes a model in binary format, returns false on failure
+        bool WriteBinary(std::ostream& stream, const Model& model);
+    }
+}
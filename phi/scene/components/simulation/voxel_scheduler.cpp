@@ -0,0 +1,123 @@
+#include "voxel_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <phi/scene/node.hpp>
+#include <phi/scene/components/transform.hpp>
+#include <phi/scene/components/simulation/voxel_object.hpp>
+
+namespace Phi
+{
+    VoxelScheduler::VoxelScheduler()
+    {
+    }
+
+    VoxelScheduler::~VoxelScheduler()
+    {
+    }
+
+    void VoxelScheduler::Update(float delta, std::span<VoxelObject* const> objects, const glm::vec3* viewer)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point frameStart = Clock::now();
+        frame++;
+
+        // Advance each simulated object's lag at its current tick rate
+        queue.clear();
+        for (VoxelObject* object : objects)
+        {
+            VoxelObject::SimulationStats& stats = object->simulationStats;
+            stats.ticks = 0;
+            if (!object->IsSimulated())
+            {
+                stats.lag = 0.0f;
+                continue;
+            }
+
+            // Tick rate falls off with distance from the viewer (to the centre of the object's AABB)
+            float rate = object->updatesPerSecond;
+            if (viewer)
+            {
+                const IAABB& aabb = object->GetAABB();
+                glm::vec3 centre = glm::vec3(aabb.min + aabb.max) * 0.5f;
+                Node* node = object->GetNode();
+                const Transform* transform = node ? node->Get<Transform>() : nullptr;
+                if (transform) centre = glm::vec3(transform->GetGlobalMatrix() * glm::vec4(centre, 1.0f));
+
+                const float distance = glm::distance(centre, *viewer);
+                if (distance > fullRateDistance) rate = std::max(rate * fullRateDistance / distance, std::min(minTickRate, rate));
+            }
+            stats.tickRate = rate;
+
+            // Drop ticks that could never be caught up on
+            const float interval = 1.0f / rate;
+            const float maxLag = maxSubsteps * interval;
+            stats.lag += delta;
+            if (stats.lag > maxLag)
+            {
+                const uint64_t dropped = (uint64_t)((stats.lag - maxLag) / interval);
+                stats.droppedTicks += dropped;
+                stats.lag -= dropped * interval;
+            }
+
+            if (stats.lag >= interval) queue.push_back(object);
+        }
+
+        // Objects furthest behind (in whole ticks owed) go first, then those that have waited longest
+        std::stable_sort(queue.begin(), queue.end(), [](const VoxelObject* a, const VoxelObject* b)
+        {
+            const int owedA = a->simulationStats.lag * a->simulationStats.tickRate;
+            const int owedB = b->simulationStats.lag * b->simulationStats.tickRate;
+            if (owedA != owedB) return owedA > owedB;
+            return a->simulationStats.lastTickFrame < b->simulationStats.lastTickFrame;
+        });
+
+        // Each pass gives every object that still owes time one tick, so catch-up substeps are spread fairly
+        // An object is skipped once its expected cost no longer fits in the budget (unless nothing has run yet)
+        frameTicks = 0;
+        deferredTicks = 0;
+        float elapsed = 0.0f;
+        for (int pass = 0; pass < maxSubsteps; ++pass)
+        {
+            bool ticked = false;
+            for (VoxelObject* object : queue)
+            {
+                VoxelObject::SimulationStats& stats = object->simulationStats;
+                const float interval = 1.0f / stats.tickRate;
+                if (stats.lag < interval) continue;
+                if (frameTicks > 0 && elapsed + stats.tickCost > budget) continue;
+
+                const Clock::time_point tickStart = Clock::now();
+                object->Step();
+                const Clock::time_point tickEnd = Clock::now();
+
+                // Update statistics
+                const float cost = std::chrono::duration<float, std::milli>(tickEnd - tickStart).count();
+                stats.tickCost = stats.tickCost == 0.0f ? cost : stats.tickCost + (cost - stats.tickCost) * COST_SMOOTHING;
+                stats.lag -= interval;
+                stats.ticks++;
+                stats.lastTickFrame = frame;
+                frameTicks++;
+                ticked = true;
+                elapsed = std::chrono::duration<float, std::milli>(tickEnd - frameStart).count();
+            }
+            if (!ticked) break;
+        }
+
+        // Count the ticks still owed, which carry over to the next frame
+        for (const VoxelObject* object : queue)
+        {
+            deferredTicks += (int)(object->simulationStats.lag * object->simulationStats.tickRate);
+        }
+        frameTime = elapsed;
+
+        // Islands are detached and meshes updated once per frame, however many ticks ran
+        for (VoxelObject* object : objects)
+        {
+            object->DetachIslands();
+            object->RefreshMesh();
+        }
+    }
+}
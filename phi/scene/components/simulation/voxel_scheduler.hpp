@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Phi
+{
+    // Forward declarations
+    class VoxelObject;
+
+    // Schedules simulation ticks for a set of voxel objects within a per-frame time budget
+    // Each object owes simulation time (lag) at its own tick rate, which drops with distance from the viewer.
+    // Every frame, the objects furthest behind tick first, one tick per pass, and further passes run
+    // catch-up substeps until the budget or the substep limit is reached. Objects that miss out this frame
+    // keep their lag and go first next frame, so ticks that would line up are spread across frames
+    class VoxelScheduler
+    {
+        // Interface
+        public:
+
+            VoxelScheduler();
+            ~VoxelScheduler();
+
+            // Delete copy constructor/assignment
+            VoxelScheduler(const VoxelScheduler&) = delete;
+            VoxelScheduler& operator=(const VoxelScheduler&) = delete;
+
+            // Delete move constructor/assignment
+            VoxelScheduler(VoxelScheduler&& other) = delete;
+            VoxelScheduler& operator=(VoxelScheduler&& other) = delete;
+
+            // Advances every object by delta seconds, running as many owed ticks as fit within the budget,
+            // then updates the mesh of each object that needs it
+            // viewer is the world space position tick rates are based on, or nullptr to run every object at its full rate
+            // NOTE: At least one tick runs per frame if any is owed, even if it exceeds the budget
+            void Update(float delta, std::span<VoxelObject* const> objects, const glm::vec3* viewer);
+
+            // Settings
+
+            // Sets the time spent on simulation ticks per frame, in milliseconds
+            inline void SetBudget(float milliseconds) { budget = glm::max(milliseconds, 0.0f); }
+            inline float GetBudget() const { return budget; }
+
+            // Sets the distance from the viewer within which objects tick at their full rate
+            // Beyond it, tick rates fall off with the inverse of the distance
+            inline void SetFullRateDistance(float distance) { fullRateDistance = glm::max(distance, 0.0f); }
+            inline float GetFullRateDistance() const { return fullRateDistance; }
+
+            // Sets the lowest tick rate of distant objects, in ticks per second
+            inline void SetMinTickRate(float rate) { minTickRate = glm::max(rate, 0.01f); }
+            inline float GetMinTickRate() const { return minTickRate; }
+
+            // Sets the maximum number of ticks an object may run in one frame
+            // Objects owing more than this many ticks drop the excess, rather than falling further behind
+            inline void SetMaxSubsteps(int substeps) { maxSubsteps = glm::max(substeps, 1); }
+            inline int GetMaxSubsteps() const { return maxSubsteps; }
+
+            // Statistics
+
+            // Returns the time spent on simulation ticks during the last frame, in milliseconds
+            inline float GetFrameTime() const { return frameTime; }
+
+            // Returns the number of ticks run during the last frame
+            inline int GetFrameTicks() const { return frameTicks; }
+
+            // Returns the number of owed ticks that were deferred to a later frame during the last frame
+            inline int GetDeferredTicks() const { return deferredTicks; }
+
+        // Data / implementation
+        private:
+
+            // Settings
+            float budget = 4.0f;
+            float fullRateDistance = 128.0f;
+            float minTickRate = 5.0f;
+            int maxSubsteps = 4;
+
+            // Statistics
+            uint64_t frame = 0;
+            float frameTime = 0.0f;
+            int frameTicks = 0;
+            int deferredTicks = 0;
+
+            // Objects owing at least one tick this frame
+            std::vector<VoxelObject*> queue;
+
+            // Weight of the newest measurement in each object's moving average tick cost
+            static constexpr float COST_SMOOTHING = 0.2f;
+    };
+}
@@ -229,13 +229,17 @@ namespace Phi
         }
 
         // Update all voxel objects
+        // Ticks are spread across frames within the scheduler's budget, at lower rates far from the camera
+        voxelObjectQueue.clear();
         for (auto&&[_, voxelObject] : registry.view<VoxelObject>().each())
         {
-            voxelObject.Update(delta);
+            voxelObjectQueue.push_back(&voxelObject);
             
             // Draw aabbs if requested
             if (debugDrawing) Debug::Instance().DrawAABB(voxelObject.GetAABB());
         }
+        const glm::vec3 viewer = activeCamera ? activeCamera->GetPosition() : glm::vec3(0.0f);
+        voxelScheduler.Update(delta, voxelObjectQueue, activeCamera ? &viewer : nullptr);
 
         // Perform frustum culling if enabled
         if (activeCamera && cullingEnabled)
@@ -578,25 +582,34 @@ namespace Phi
         return id;
     }
 
-    int Scene::RegisterMaterial(const std::string& name, const VoxelMaterial& material)
+    int Scene::AddVoxelMaterial(const std::string& name, const VoxelMaterial& material)
     {
         // Find if the material exists
-        const auto& it = voxelMaterialIDs.find(name);
+        int id = voxelMaterialTable.Find(name);
 
-        if (it != voxelMaterialIDs.end())
+        if (id != -1)
         {
             // Material with provided name exists, replace it
-            voxelMaterials[it->second] = material;
-            return it->second;
+            voxelMaterials[id] = material;
         }
         else
         {
-            // Material does not exist, add it and add the ID to the map
-            int id = voxelMaterials.size();
-            voxelMaterialIDs[name] = id;
+            // Material does not exist, add it
+            id = voxelMaterials.size();
             voxelMaterials.push_back(material);
-            return id;
         }
+
+        // Keep the name to ID map in the simulation table up to date
+        voxelMaterialTable.Set(id, name, material);
+        return id;
+    }
+
+    int Scene::RegisterMaterial(const std::string& name, const VoxelMaterial& material)
+    {
+        // Rules are recompiled since they may refer to this material by name
+        const int id = AddVoxelMaterial(name, material);
+        voxelMaterialTable.Compile(voxelMaterials);
+        return id;
     }
 
     const PBRMaterial& Scene::GetPBRMaterial(int id) const
@@ -628,17 +641,9 @@ namespace Phi
 
     int Scene::GetVoxelMaterialID(const std::string& name) const
     {
-        // Find if the material exists
-        const auto& it = voxelMaterialIDs.find(name);
-
-        if (it != voxelMaterialIDs.end())
-        {
-            // Material with provided name exists
-            return it->second;
-        }
-
-        // Does not exist, return default value
-        return 0;
+        // Return the default material if none exists with the given name
+        const int id = voxelMaterialTable.Find(name);
+        return id == -1 ? 0 : id;
     }
 
     void Scene::LoadMaterials(const std::string& path)
@@ -693,13 +698,31 @@ namespace Phi
                     // Load properties from node
                     m.name = mat["name"] ? mat["name"].as<std::string>() : "new_material";
                     m.flammability = mat["flammability"] ? mat["flammability"].as<float>() : m.flammability;
+                    m.density = mat["density"] ? mat["density"].as<float>() : m.density;
+                    m.conductivity = mat["conductivity"] ? mat["conductivity"].as<float>() : m.conductivity;
+                    m.meltingPoint = mat["melting_point"] ? mat["melting_point"].as<float>() : m.meltingPoint;
+                    m.burnProduct = mat["burns_into"] ? mat["burns_into"].as<std::string>() : m.burnProduct;
+                    m.burnRate = mat["burn_rate"] ? mat["burn_rate"].as<float>() : m.burnRate;
+
+                    // Reactions with neighbouring materials
+                    for (auto& reaction : mat["reactions"])
+                    {
+                        VoxelMaterial::Reaction r;
+                        r.neighbour = reaction["with"] ? reaction["with"].as<std::string>() : r.neighbour;
+                        r.product = reaction["becomes"] ? reaction["becomes"].as<std::string>() : r.product;
+                        r.chance = reaction["chance"] ? reaction["chance"].as<float>() : r.chance;
+                        m.reactions.push_back(r);
+                    }
 
                     // Material flag parsing
                     // TODO: This can be faster
                     for (auto& flag : mat["flags"])
                     {
                         std::string flagName = flag.as<std::string>();
+                        if (flagName == "solid") m.flags |= VoxelMaterial::Flags::Solid;
                         if (flagName == "liquid") m.flags |= VoxelMaterial::Flags::Liquid;
+                        if (flagName == "gas") m.flags |= VoxelMaterial::Flags::Gas;
+                        if (flagName == "powder") m.flags |= VoxelMaterial::Flags::Powder;
                         if (flagName == "fire") m.flags |= VoxelMaterial::Flags::Fire;
                     }
 
@@ -707,7 +730,7 @@ namespace Phi
                     m.pbrID = mat["pbr_name"] ? GetPBRMaterialID(mat["pbr_name"].as<std::string>()) : m.pbrID;
 
                     // Add the material to the scene
-                    RegisterMaterial(m.name, m);
+                    AddVoxelMaterial(m.name, m);
                 }
             }
         }
@@ -715,6 +738,9 @@ namespace Phi
         {
             Error("YAML Parser Error: ", path);
         }
+
+        // Compile the rules once every material they may refer to is known (including after a parse error part way through)
+        voxelMaterialTable.Compile(voxelMaterials);
     }
 
     void Scene::SetActiveCamera(Camera& camera)
@@ -811,6 +837,19 @@ namespace Phi
             }
         }
 
+        ImGui::SeparatorText("Voxel Simulation");
+        float budget = voxelScheduler.GetBudget();
+        if (ImGui::DragFloat("Budget (ms)", &budget, 0.1f, 0.0f, 100.0f)) voxelScheduler.SetBudget(budget);
+        float fullRateDistance = voxelScheduler.GetFullRateDistance();
+        if (ImGui::DragFloat("Full Rate Distance", &fullRateDistance, 1.0f, 0.0f, 16'384.0f)) voxelScheduler.SetFullRateDistance(fullRateDistance);
+        ImGui::Text("Last frame: %d ticks, %.2f ms, %d deferred", voxelScheduler.GetFrameTicks(), voxelScheduler.GetFrameTime(), voxelScheduler.GetDeferredTicks());
+        for (size_t i = 0; i < voxelObjectQueue.size(); ++i)
+        {
+            const VoxelObject::SimulationStats& stats = voxelObjectQueue[i]->GetSimulationStats();
+            ImGui::Text("Object %zu: %.2f ms/tick, %.0f ticks/s, lag %.1f ms, %llu dropped",
+                        i, stats.tickCost, stats.tickRate, stats.lag * 1000.0f, (unsigned long long)stats.droppedTicks);
+        }
+
         ImGui::SeparatorText("Camera");
         if (activeCamera)
         {
@@ -26,6 +26,7 @@
 #include <phi/scene/components/renderable/voxel_mesh.hpp>
 #include <phi/scene/components/simulation/voxel_map.hpp>
 #include <phi/scene/components/simulation/voxel_material.hpp>
+#include <phi/scene/components/simulation/voxel_scheduler.hpp>
 
 // Forward declaration of editor
 class Editor;
@@ -169,6 +170,9 @@ namespace Phi
             inline const std::vector<PBRMaterial>& GetPBRMaterials() const { return pbrMaterials; }
             inline const std::vector<VoxelMaterial>& GetVoxelMaterials() const { return voxelMaterials; }
 
+            // Const access to the simulation properties of every voxel material, used by simulation loops
+            inline const VoxelMaterialTable& GetVoxelMaterialTable() const { return voxelMaterialTable; }
+
             // Camera management
 
             // Returns the currently active camera for the scene
@@ -209,6 +213,11 @@ namespace Phi
             // NOTE: Does not delete the component!
             void RemoveVoxelMap();
 
+            // Voxel object simulation
+
+            // Returns the scheduler that ticks every voxel object in the scene within a per-frame budget
+            VoxelScheduler& GetVoxelScheduler() { return voxelScheduler; }
+
             // Lighting
 
             // Sets the base ambient light in the scene
@@ -303,7 +312,11 @@ namespace Phi
 
             // Voxel materials
             std::vector<VoxelMaterial> voxelMaterials;
-            std::unordered_map<std::string, int> voxelMaterialIDs;
+            VoxelMaterialTable voxelMaterialTable;
+
+            // Voxel object simulation
+            VoxelScheduler voxelScheduler;
+            std::vector<VoxelObject*> voxelObjectQueue;
 
             // Lighting data
 
@@ -329,6 +342,10 @@ namespace Phi
 
             // Helper functions
             void RegenerateFramebuffers();
+
+            // Adds or replaces a voxel material without recompiling the simulation table, returns its ID
+            // Callers must recompile the table once they are done adding materials
+            int AddVoxelMaterial(const std::string& name, const VoxelMaterial& material);
         
         // Friends
         private:
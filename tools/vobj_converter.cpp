@@ -0,0 +1,55 @@
+// Converts text .vobj files to the binary .vobj format
+// Usage: vobj_converter <input.vobj> <output.vobj>
+
+#include <fstream>
+
+#include <phi/core/logging.hpp>
+#include <phi/core/mapped_file.hpp>
+#include <phi/scene/components/simulation/voxel_object_format.hpp>
+
+using namespace Phi;
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        Log("Usage: vobj_converter <input.vobj> <output.vobj>");
+        return 1;
+    }
+    const std::string inputPath = argv[1];
+    const std::string outputPath = argv[2];
+
+    // Map the input file
+    MappedFile mappedFile(inputPath);
+    if (!mappedFile.IsOpen())
+    {
+        Error("File could not be opened: ", inputPath);
+        return 1;
+    }
+
+    // Nothing to do for files that are already binary
+    if (VoxelObjectFormat::IsBinary(mappedFile.GetData(), mappedFile.GetSize()))
+    {
+        Error("Already in binary format: ", inputPath);
+        return 1;
+    }
+
+    // Parse the text file
+    VoxelObjectFormat::Model model;
+    if (!VoxelObjectFormat::ParseText((const char*)mappedFile.GetData(), mappedFile.GetSize(), model))
+    {
+        Error("Invalid voxel object file: ", inputPath);
+        return 1;
+    }
+
+    // Write the binary file
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open() || !VoxelObjectFormat::WriteBinary(output, model))
+    {
+        Error("File could not be written: ", outputPath);
+        return 1;
+    }
+
+    Log("Converted ", inputPath, " -> ", outputPath, " (", model.materials.size(), " materials, ", model.records.size(), " voxels)");
+    return 0;
+}
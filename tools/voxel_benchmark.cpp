@@ -0,0 +1,379 @@
+// Headless voxel simulation benchmark
+// Runs a fixed number of simulation ticks on each model in data/models and on synthetic fluid, fire, powder, and reaction scenes,
+// then reports the time per voxel-tick, peak memory, and a checksum of the final voxel state
+// Each model is also raycast before simulating, comparing scalar and batched rays/s
+// Checksums only depend on the scenes and the tick count, so a changed checksum means changed simulation behaviour
+// Checksums are compared against EXPECTED_CHECKSUMS, and the tool exits with 1 if any differ (or a model fails to load)
+// Usage: voxel_benchmark [ticks] [threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <phi/core/file.hpp>
+#include <phi/core/logging.hpp>
+#include <phi/scene/components/simulation/voxel_object.hpp>
+
+using namespace Phi;
+
+// Material IDs used by the benchmark scenes
+// Mirrors the voxel materials in data/materials.yaml, but is fixed here so that checksums stay comparable
+enum BenchmarkMaterial : int16_t
+{
+    Default = 0,
+    Grass,
+    Water,
+    Lava,
+    Silver,
+    Wood,
+    Ash,
+    Sand,
+    Steam,
+    Stone
+};
+
+// Known checksums of each scene after a given number of ticks (independent of the thread count)
+// When a change alters simulation behaviour on purpose, update these and say why in the commit
+struct ExpectedChecksum
+{
+    const char* scene;
+    int ticks;
+    uint64_t checksum;
+};
+static const ExpectedChecksum EXPECTED_CHECKSUMS[] =
+{
+    {"dragon.vobj",   100, 0x34d0a710b93dd37dull},
+    {"dragon.vobj",   200, 0xe5d64dec36cf7c03ull},
+    {"dragon.vobj",   500, 0xee7943b110feb86cull},
+    {"mushroom.vobj", 100, 0x8e30c5daf2a47920ull},
+    {"mushroom.vobj", 200, 0x8e30c5daf2a47920ull},
+    {"mushroom.vobj", 500, 0x8e30c5daf2a47920ull},
+    {"teapot.vobj",   100, 0x2f4890c679083faaull},
+    {"teapot.vobj",   200, 0x7eba9919f9764f7dull},
+    {"teapot.vobj",   500, 0xb3b13ea6dddbf990ull},
+    {"fluid",         100, 0x0d15120fb02528f6ull},
+    {"fluid",         200, 0xa8f752026d90b38dull},
+    {"fluid",         500, 0x3aa5f5d828e6de06ull},
+    {"fire",          100, 0x0d951dfc6aeb0da4ull},
+    {"fire",          200, 0xd3bf54a3c07414eaull},
+    {"fire",          500, 0xaceea09b28776767ull},
+    {"burn",          100, 0xca093175ac95e26full},
+    {"burn",          200, 0x04bf11c1dd11584cull},
+    {"burn",          500, 0x3b0bb827ff4d26b8ull},
+    {"powder",        100, 0x6e12d155ff998c3full},
+    {"powder",        200, 0x410d7816d78ddd55ull},
+    {"powder",        500, 0xd284d722f186a1b7ull},
+    {"reaction",      100, 0x4e0fbde0b0e5263bull},
+    {"reaction",      200, 0xeeed48c1283cb6c9ull},
+    {"reaction",      500, 0x673e8708b0cb544bull},
+};
+
+// Builds the material table used by every benchmark scene
+static VoxelMaterialTable CreateMaterials()
+{
+    std::vector<VoxelMaterial> materials;
+    materials.emplace_back("default");
+
+    VoxelMaterial& grass = materials.emplace_back("grass", VoxelMaterial::Flags::Solid);
+    grass.flammability = 0.1f;
+
+    VoxelMaterial& water = materials.emplace_back("water", VoxelMaterial::Flags::Liquid);
+    water.reactions.push_back({"lava", "steam", 0.05f});
+
+    VoxelMaterial& lava = materials.emplace_back("lava", VoxelMaterial::Flags::Liquid | VoxelMaterial::Flags::Fire);
+    lava.reactions.push_back({"water", "stone", 0.05f});
+
+    materials.emplace_back("silver", VoxelMaterial::Flags::Solid);
+
+    VoxelMaterial& wood = materials.emplace_back("wood", VoxelMaterial::Flags::Solid);
+    wood.flammability = 0.5f;
+    wood.burnProduct = "ash";
+    wood.burnRate = 0.01f;
+
+    materials.emplace_back("ash", VoxelMaterial::Flags::Powder);
+    materials.emplace_back("sand", VoxelMaterial::Flags::Powder);
+    materials.emplace_back("steam", VoxelMaterial::Flags::Gas);
+    materials.emplace_back("stone", VoxelMaterial::Flags::Solid);
+
+    VoxelMaterialTable table;
+    for (int id = 0; id < materials.size(); ++id)
+    {
+        table.Set(id, materials[id].name, materials[id]);
+    }
+    table.Compile(materials);
+    return table;
+}
+
+// Returns an order-independent checksum of every voxel in the object
+static uint64_t Checksum(const VoxelObject& object)
+{
+    uint64_t sum = 0;
+    for (const Voxel& voxel : object.GetVoxels())
+    {
+        // SplitMix64 finalizer over the packed voxel state
+        uint64_t x = (uint64_t)(uint16_t)voxel.x | (uint64_t)(uint16_t)voxel.y << 16 | (uint64_t)(uint16_t)voxel.z << 32 |
+                     (uint64_t)(uint16_t)voxel.material << 48;
+        x ^= (uint64_t)voxel.flags * 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        sum += x ^ (x >> 31);
+    }
+    return sum;
+}
+
+// Formats a checksum as 16 hex digits
+static std::string FormatChecksum(uint64_t checksum)
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << checksum;
+    return stream.str();
+}
+
+// Returns the peak resident memory of the process, in bytes
+static size_t PeakMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// Fills the empty cells of the given object-local box with a material
+static void Fill(VoxelObject& object, const glm::ivec3& min, const glm::ivec3& max, int16_t material, bool onlyEmpty = true)
+{
+    std::vector<VoxelObject::Edit> edits;
+    for (int z = min.z; z < max.z; ++z)
+    {
+        for (int y = min.y; y < max.y; ++y)
+        {
+            for (int x = min.x; x < max.x; ++x)
+            {
+                if (onlyEmpty && object.GetVoxel(x, y, z)) continue;
+                edits.push_back({(int16_t)x, (int16_t)y, (int16_t)z, material});
+            }
+        }
+    }
+    object.ApplyEdits(edits);
+}
+
+// Traces a fixed grid of rays at the object with RaycastFirst() and RaycastBatch(), and logs the rays/s of each
+// Batches are kept to a single RaycastBatch() job so both paths run on the calling thread
+// Returns false if the two paths disagree on any hit
+static bool RunRaycasts(const std::string& name, const VoxelObject& object)
+{
+    // Rays fan out from a point beyond a corner of the object towards a plane through its centre
+    constexpr int RAYS_PER_AXIS = 256;
+    constexpr int REPEATS = 4;
+    const IAABB aabb = object.GetAABB();
+    const glm::vec3 size = aabb.max - aabb.min;
+    const glm::vec3 centre = glm::vec3(aabb.min) + size * 0.5f;
+    const glm::vec3 eye = centre + glm::vec3(-0.6f, 0.8f, -1.0f) * glm::max(size.x, glm::max(size.y, size.z)) * 1.5f;
+    std::vector<Ray> rays;
+    rays.reserve(RAYS_PER_AXIS * RAYS_PER_AXIS);
+    for (int v = 0; v < RAYS_PER_AXIS; ++v)
+    {
+        for (int u = 0; u < RAYS_PER_AXIS; ++u)
+        {
+            const glm::vec3 target = glm::vec3(aabb.min) + size * glm::vec3((u + 0.5f) / RAYS_PER_AXIS, (v + 0.5f) / RAYS_PER_AXIS, 0.5f);
+            rays.emplace_back(eye, glm::normalize(target - eye));
+        }
+    }
+
+    // Scalar
+    std::vector<VoxelObject::RaycastHit> scalarHits(rays.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; ++r)
+    {
+        for (size_t i = 0; i < rays.size(); ++i) scalarHits[i] = object.RaycastFirst(rays[i]);
+    }
+    const std::chrono::duration<double> scalarElapsed = std::chrono::steady_clock::now() - start;
+
+    // Batched, in single-job batches
+    constexpr size_t BATCH_SIZE = VoxelObject::RAYS_PER_PACKET * 128;
+    std::vector<VoxelObject::RaycastHit> batchHits(rays.size());
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; ++r)
+    {
+        for (size_t i = 0; i < rays.size(); i += BATCH_SIZE)
+        {
+            const size_t count = std::min(BATCH_SIZE, rays.size() - i);
+            object.RaycastBatch(std::span(rays).subspan(i, count), std::span(batchHits).subspan(i, count));
+        }
+    }
+    const std::chrono::duration<double> batchElapsed = std::chrono::steady_clock::now() - start;
+
+    // Both paths must agree exactly
+    size_t hitCount = 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        const VoxelObject::RaycastHit& a = scalarHits[i];
+        const VoxelObject::RaycastHit& b = batchHits[i];
+        hitCount += a.hit;
+        if (a.hit != b.hit || (a.hit && (a.normal != b.normal || a.distance != b.distance || a.voxel.x != b.voxel.x ||
+                                         a.voxel.y != b.voxel.y || a.voxel.z != b.voxel.z))) mismatches++;
+    }
+
+    const double rayCount = (double)rays.size() * REPEATS;
+    Log(name, " raycasts: ", rays.size(), " rays (", hitCount, " hits), ",
+        rayCount / scalarElapsed.count() * 1e-6, " Mrays/s scalar, ",
+        rayCount / batchElapsed.count() * 1e-6, " Mrays/s batched (",
+        scalarElapsed.count() / std::max(batchElapsed.count(), 1e-9), "x)");
+    if (mismatches > 0)
+    {
+        Error(name, " raycasts: ", mismatches, " batched results differ from RaycastFirst()");
+        return false;
+    }
+    return true;
+}
+
+// Runs the given number of ticks on the object and logs the results
+// Returns false if the final checksum differs from the expected one (scenes and tick counts without one always pass)
+static bool Run(const std::string& name, VoxelObject& object, int ticks, int threads)
+{
+    object.SetThreadCount(threads);
+    object.Enable(VoxelObject::Flags::SimulateFluids | VoxelObject::Flags::SimulateFire | VoxelObject::Flags::SimulateReactions |
+                  VoxelObject::Flags::KeepSorted);
+
+    // Time each tick, counting every voxel simulated (or skipped) by it
+    uint64_t voxelTicks = 0;
+    std::chrono::duration<double> elapsed(0);
+    for (int i = 0; i < ticks; ++i)
+    {
+        voxelTicks += object.GetVoxels().size();
+        const auto start = std::chrono::steady_clock::now();
+        object.Update(1.0f);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    const uint64_t checksum = Checksum(object);
+    Log(name, ": ", object.GetVoxels().size(), " voxels, ",
+        elapsed.count() * 1e9 / std::max<uint64_t>(voxelTicks, 1), " ns/voxel-tick, ",
+        elapsed.count() * 1e3 / std::max(ticks, 1), " ms/tick, ",
+        "peak memory ", PeakMemory() / (1024 * 1024), " MiB, ",
+        "checksum ", FormatChecksum(checksum));
+
+    // Compare against the expected checksum, if there is one
+    const auto expected = std::find_if(std::begin(EXPECTED_CHECKSUMS), std::end(EXPECTED_CHECKSUMS), [&](const ExpectedChecksum& entry)
+    {
+        return entry.scene == name && entry.ticks == ticks;
+    });
+    if (expected == std::end(EXPECTED_CHECKSUMS))
+    {
+        Log(name, ": no expected checksum for ", ticks, " ticks");
+        return true;
+    }
+    if (expected->checksum != checksum)
+    {
+        Error(name, ": checksum ", FormatChecksum(checksum), " does not match expected ", FormatChecksum(expected->checksum),
+              " after ", ticks, " ticks");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const int ticks = argc > 1 ? std::atoi(argv[1]) : 500;
+    const int threads = argc > 2 ? std::atoi(argv[2]) : 0;
+    Log("Running ", ticks, " ticks per scene on ", threads == 0 ? std::string("all") : std::to_string(threads), " threads");
+
+    File::Init();
+    const VoxelMaterialTable materials = CreateMaterials();
+
+    // Models, with a layer of lava poured over the top of each
+    // Model materials missing from the table load as the default material
+    std::vector<std::string> models;
+    for (const auto& entry : std::filesystem::directory_iterator(File::GlobalizePath("data://models")))
+    {
+        if (entry.path().extension() == ".vobj") models.push_back(entry.path().filename().string());
+    }
+    std::sort(models.begin(), models.end());
+    bool passed = true;
+    for (const std::string& model : models)
+    {
+        VoxelObject object;
+        object.SetMaterialTable(&materials);
+        if (!object.Load("data://models/" + model))
+        {
+            passed = false;
+            continue;
+        }
+
+        passed &= RunRaycasts(model, object);
+
+        const IAABB aabb = object.GetAABB();
+        Fill(object, glm::ivec3(aabb.min.x, aabb.max.y - 2, aabb.min.z), aabb.max, Lava);
+        passed &= Run(model, object, ticks, threads);
+    }
+
+    // Synthetic fluid scene: a block of water falling to the floor of a silver basin
+    {
+        VoxelObject object(96, 96, 96, glm::ivec3(-48));
+        object.SetMaterialTable(&materials);
+        Fill(object, glm::ivec3(-48, -48, -48), glm::ivec3(48, -47, 48), Silver);
+        Fill(object, glm::ivec3(-32, 0, -32), glm::ivec3(32, 40, 32), Water);
+        passed &= Run("fluid", object, ticks, threads);
+    }
+
+    // Synthetic fire scene: a slab of grass with a pool of lava in the middle
+    {
+        VoxelObject object(128, 16, 128, glm::ivec3(-64, -8, -64));
+        object.SetMaterialTable(&materials);
+        Fill(object, glm::ivec3(-64, -8, -64), glm::ivec3(64, 0, 64), Grass);
+        Fill(object, glm::ivec3(-4, -1, -4), glm::ivec3(4, 0, 4), Lava, false);
+        passed &= Run("fire", object, ticks, threads);
+    }
+
+    // Synthetic burn scene: a wooden floor that burns down to ash, with a pool of lava in the middle
+    {
+        VoxelObject object(128, 16, 128, glm::ivec3(-64, -8, -64));
+        object.SetMaterialTable(&materials);
+        Fill(object, glm::ivec3(-64, -8, -64), glm::ivec3(64, -7, 64), Silver);
+        Fill(object, glm::ivec3(-64, -7, -64), glm::ivec3(64, 0, 64), Wood);
+        Fill(object, glm::ivec3(-4, -1, -4), glm::ivec3(4, 0, 4), Lava, false);
+        passed &= Run("burn", object, ticks, threads);
+    }
+
+    // Synthetic powder scene: a column of sand piling up on a stone floor, under a layer of steam
+    {
+        VoxelObject object(96, 96, 96, glm::ivec3(-48));
+        object.SetMaterialTable(&materials);
+        Fill(object, glm::ivec3(-48, -48, -48), glm::ivec3(48, -47, 48), Stone);
+        Fill(object, glm::ivec3(-8, -20, -8), glm::ivec3(8, 40, 8), Sand);
+        Fill(object, glm::ivec3(-32, -46, -32), glm::ivec3(32, -40, 32), Steam);
+        passed &= Run("powder", object, ticks, threads);
+    }
+
+    // Synthetic reaction scene: lava poured into a basin of water
+    {
+        VoxelObject object(96, 96, 96, glm::ivec3(-48));
+        object.SetMaterialTable(&materials);
+        Fill(object, glm::ivec3(-48, -48, -48), glm::ivec3(48, -47, 48), Silver);
+        Fill(object, glm::ivec3(-32, -47, -32), glm::ivec3(32, -40, 32), Water);
+        Fill(object, glm::ivec3(-12, -20, -12), glm::ivec3(12, 0, 12), Lava);
+        passed &= Run("reaction", object, ticks, threads);
+    }
+
+    return passed ? 0 : 1;
+}
@@ -49,16 +49,17 @@ VoxelEditor::VoxelEditor() : App("Voxel Editor", 1280, 720)
     const auto& aabb = object->GetAABB();
     Noise noise;
     noise.SetFrequency(0.032f);
+    std::vector<VoxelObject::Edit> edits;
     for (int y = aabb.max.y - 1; y >= aabb.min.y; --y)
     {
         for (int z = aabb.min.z; z < aabb.max.z; ++z)
         {
             for (int x = aabb.min.x; x < aabb.max.x; ++x)
             {
-                Voxel v;
-                v.x = x;
-                v.y = y;
-                v.z = z;
+                VoxelObject::Edit edit;
+                edit.x = x;
+                edit.y = y;
+                edit.z = z;
                 if (y < aabb.max.y - 4)
                 {
                     if (noise.Sample(x, y, z) < 0.0f)
@@ -67,23 +68,27 @@ VoxelEditor::VoxelEditor() : App("Voxel Editor", 1280, 720)
                     }
                     else
                     {
-                        v.material = grass;
+                        edit.material = grass;
                     }
                 }
                 else
                 {
-                    v.material = water;
+                    edit.material = water;
                 }
                 
-                object->SetVoxel(v.x, v.y, v.z, v.material);
+                edits.push_back(edit);
             }
         }
     }
+    object->ApplyEdits(edits);
     object->UpdateMesh();
 
     // Testing different object configurations
     object->Enable(VoxelObject::Flags::SimulateFluids);
     object->Enable(VoxelObject::Flags::SimulateFire);
+    object->Enable(VoxelObject::Flags::SimulateReactions);
+    object->Enable(VoxelObject::Flags::KeepSorted);
+    object->Enable(VoxelObject::Flags::SplitIslands);
 
     // Default material
     selectedVoxel.material = scene.GetVoxelMaterialID("lava");
@@ -117,13 +122,17 @@ void VoxelEditor::Update(float delta)
     
     // Update selected position if we hit a solid voxel with the mouse
     Ray ray = cam->GenerateRay(mousePos.x - toolBarWidth, mousePos.y);
-    VoxelObject::RaycastInfo result = object->Raycast(ray);
-    if (result.firstHit != -1)
+    VoxelObject::RaycastHit result = object->RaycastFirst(ray);
+    if (result.hit)
     {
-        const Voxel& hitVoxel = result.visitedVoxels[result.firstHit > 0 ? result.firstHit - 1 : 0];
-        selectedVoxel.x = hitVoxel.x;
-        selectedVoxel.y = hitVoxel.y;
-        selectedVoxel.z = hitVoxel.z;
+        // Adding targets the empty voxel in front of the hit, painting and erasing target the hit itself
+        // The voxel in front may lie outside the grid, in which case adding targets the hit too
+        const glm::ivec3 hitPosition(result.voxel.x, result.voxel.y, result.voxel.z);
+        glm::ivec3 selected = hitPosition;
+        if (brushMode == BrushMode::Add && object->IsInGrid(hitPosition + result.normal)) selected += result.normal;
+        selectedVoxel.x = selected.x;
+        selectedVoxel.y = selected.y;
+        selectedVoxel.z = selected.z;
     }
 
     glm::ivec3 selectedPosition = glm::ivec3(selectedVoxel.x, selectedVoxel.y, selectedVoxel.z);
@@ -145,18 +154,25 @@ void VoxelEditor::Update(float delta)
             v.z = selectedVoxel.z;
             v.material = selectedVoxel.material;
             brushMesh->Vertices().push_back(v);
+            brushMesh->MarkDirty(brushMesh->Vertices().size() - 1);
         }
     }
     else if (input.IsLMBReleased())
     {
-        // Flush brush stroke edits
+        // Flush brush stroke edits as a single batch
+        std::vector<VoxelObject::Edit> edits;
+        edits.reserve(currentEdits.size());
         for (const auto& it : currentEdits)
         {
             const Voxel& v = it.second;
-            object->SetVoxel(v.x, v.y, v.z, v.material);
+
+            // Painting only changes existing voxels
+            if (brushMode == BrushMode::Paint && !object->GetVoxel(v.x, v.y, v.z)) continue;
+
+            edits.push_back({v.x, v.y, v.z, brushMode == BrushMode::Erase ? (int16_t)-1 : v.material});
         }
+        object->ApplyEdits(edits);
         currentEdits.clear();
-        object->UpdateMesh();
         
         // Reset the brush mesh
         auto& verts = brushMesh->Vertices();
@@ -167,6 +183,7 @@ void VoxelEditor::Update(float delta)
         v.z = selectedVoxel.z;
         v.material = selectedVoxel.material;
         verts.push_back(v);
+        brushMesh->MarkAllDirty();
     }
     else
     {
@@ -176,6 +193,7 @@ void VoxelEditor::Update(float delta)
         v.y = selectedVoxel.y;
         v.z = selectedVoxel.z;
         v.material = selectedVoxel.material;
+        brushMesh->MarkDirty(0);
     }
 
     // Update the voxel world
@@ -227,7 +245,23 @@ void VoxelEditor::Render()
                  ICON_FA_BRUSH " Paint\0"
                  ICON_FA_ERASER " Erase\0");
     brushMode = (BrushMode)iBrushMode;
-    
+
+    // Mesh mode combo
+    int iMeshMode = (int)object->GetMeshMode();
+    if (ImGui::Combo("Mesh Mode", &iMeshMode,
+                     "All Voxels\0"
+                     "Culled Voxels\0"
+                     "Greedy\0"))
+    {
+        object->SetMeshMode((VoxelObject::MeshMode)iMeshMode);
+    }
+
+    // Raycast benchmark
+    if (ImGui::Button("Benchmark Raycasts")) BenchmarkRaycasts();
+    ImGui::Text("Scalar: %.2f Mrays/s", scalarRaysPerSecond / 1'000'000.0);
+    ImGui::Text("Batch: %.2f Mrays/s", batchRaysPerSecond / 1'000'000.0);
+    if (!batchMatchesScalar) ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Batch results differ!");
+
     // DEBUG: Testing different imgui methods
     static bool showDemo = false;
     ImGui::Checkbox("Show Demo Window", &showDemo);
@@ -251,4 +285,53 @@ void VoxelEditor::Render()
         ShowDebug();
         scene.ShowDebug(wWidth - 360, wHeight - 450, 360, 450);
     }
+}
+
+void VoxelEditor::BenchmarkRaycasts()
+{
+    // Generate a ray for every pixel of the viewport
+    Camera* cam = scene.GetActiveCamera();
+    const int width = wWidth - toolBarWidth;
+    std::vector<Ray> rays;
+    rays.reserve(width * wHeight);
+    for (int y = 0; y < wHeight; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            rays.push_back(cam->GenerateRay(x, y));
+        }
+    }
+    if (rays.empty()) return;
+
+    std::vector<VoxelObject::RaycastHit> scalarHits(rays.size());
+    std::vector<VoxelObject::RaycastHit> batchHits(rays.size());
+
+    // Scalar
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        scalarHits[i] = object->RaycastFirst(rays[i]);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    scalarRaysPerSecond = rays.size() / elapsed.count();
+
+    // Batch
+    start = std::chrono::steady_clock::now();
+    object->RaycastBatch(rays, batchHits);
+    elapsed = std::chrono::steady_clock::now() - start;
+    batchRaysPerSecond = rays.size() / elapsed.count();
+
+    // Both paths must agree exactly
+    batchMatchesScalar = true;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        const auto& a = scalarHits[i];
+        const auto& b = batchHits[i];
+        if (a.hit != b.hit || (a.hit && (a.distance != b.distance || a.normal != b.normal ||
+            a.voxel.x != b.voxel.x || a.voxel.y != b.voxel.y || a.voxel.z != b.voxel.z)))
+        {
+            batchMatchesScalar = false;
+            break;
+        }
+    }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
+#include <vector>
 
 // Phi engine
 #include <phi/phi.hpp>
@@ -51,6 +53,14 @@ class VoxelEditor : public Phi::App
         // Settings
         bool showDebug = false;
 
+        // Raycast benchmark results, in rays per second
+        double scalarRaysPerSecond = 0.0;
+        double batchRaysPerSecond = 0.0;
+        bool batchMatchesScalar = true;
+
+        // Casts a ray through every pixel of the viewport, both one at a time and as a batch, and records the results
+        void BenchmarkRaycasts();
+
         // Window dimensions
         int toolBarWidth = 256;
 };
\ No newline at end of file
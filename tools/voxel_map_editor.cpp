@@ -37,11 +37,18 @@ VoxelMapEditor::VoxelMapEditor() : App("Voxel Map Editor", 1280, 720)
     VoxelMap& map = scene.CreateNode()->AddComponent<VoxelMap>();
     scene.SetActiveVoxelMap(map);
 
+    // Masses are not saved between sessions, so neither are the chunks generated from them
+    map.SetCachePath("user://voxel_map_cache/");
+    map.ClearCache();
+
     Log(name, " initialized");
 }
 
 VoxelMapEditor::~VoxelMapEditor()
 {
+    // Chunks are only saved as they unload, so save edits to chunks that are still loaded
+    if (VoxelMap* map = scene.GetActiveVoxelMap()) map->SaveChunks();
+
     Log(name, " shutdown");
 }
 
@@ -130,13 +137,31 @@ void VoxelMapEditor::ShowInterface()
         // Statistics
         ImGui::SeparatorText("Statistics");
         ImGui::Text("Chunks Loaded: %lu", map->loadedChunks.size());
+        ImGui::Text("Chunks Pending: %lu", map->pendingChunks.size());
+        ImGui::Text("Chunks Streamed: %lu", map->chunksStreamed);
+        ImGui::Text("Chunks Pooled: %lu (%lu hits, %lu misses)", map->GetPooledChunkCount(), map->GetPoolHits(), map->GetPoolMisses());
         ImGui::Text("Voxels Rendered: %lu", map->voxelsRendered);
 
         // Main controls
         ImGui::SeparatorText("Controls");
 
         // Regenerates the map's terrain using the current data
-        if (ImGui::Button("Regenerate")) map->UnloadChunks();
+        if (ImGui::Button("Regenerate"))
+        {
+            map->UnloadChunks();
+            map->ClearCache();
+        }
+
+        // Sphere brush, edits persist in the chunk cache
+        ImGui::SeparatorText("Editing");
+        ImGui::DragFloat3("Brush Centre", &brushCentre.x);
+        ImGui::SameLine();
+        if (ImGui::Button("Camera")) brushCentre = scene.GetActiveCamera()->GetPosition();
+        ImGui::DragFloat("Brush Radius", &brushRadius, 0.1f, 0.0f, 64.0f);
+        ImGui::InputText("Brush Material", &brushMaterial);
+        if (ImGui::Button("Fill")) map->EditSphere(brushCentre, brushRadius, scene.GetPBRMaterialID(brushMaterial));
+        ImGui::SameLine();
+        if (ImGui::Button("Carve")) map->EditSphere(brushCentre, brushRadius, 0);
 
         // Display all voxel masses
         ImGui::SeparatorText("Voxel Masses");
@@ -163,6 +188,7 @@ void VoxelMapEditor::ShowInterface()
 
                 float frequency = mass.noise.GetFrequency();
                 if (ImGui::DragFloat("Frequency", &frequency, 0.001f, 0.0f, 1.0f)) mass.noise.SetFrequency(frequency);
+                ImGui::Checkbox("Coarse Sampling", &mass.coarseNoise);
 
                 // Material type selections
                 ImGui::Text("Materials:");
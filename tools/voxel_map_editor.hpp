@@ -33,6 +33,11 @@ class VoxelMapEditor : public Phi::App
         // Settings
         bool showGUI = true;
 
+        // Sphere brush used to edit the map
+        glm::vec3 brushCentre{0.0f};
+        float brushRadius = 8.0f;
+        std::string brushMaterial{"stone"};
+
         // Displays the main interface
         void ShowInterface();
 };
\ No newline at end of file